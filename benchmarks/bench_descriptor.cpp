@@ -0,0 +1,130 @@
+/**
+ * Converter generated from ProtocolDescriptor vs. the hand-written one:
+ * - get_sync() and get_len() called over the ring-buffer at every position;
+ * - byte-by-byte push() ( IRQ path ) of the stream of UBX msgs mixed with noise.
+ *
+ * build & run from the root of repo:
+ *  g++ -O2 -std=c++17 -D_UNIT_TEST_ -I. -Itests/test_doubles/ring_buffer \
+ *      benchmarks/bench_descriptor.cpp tests/test_doubles/ring_buffer/utils_ringbuffer.c -o bench_descriptor
+ *  ./bench_descriptor
+ */
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "tests/test_doubles/ring_buffer/utils_ringbuffer.h"
+#include "tests/test_doubles/queue/dummy_queue.hpp"
+#include "tests/test_doubles/ubx_stream_separator.hpp"
+#include "tests/test_doubles/rtos_stubs.hpp"
+
+#include "stream_separator.hpp"
+
+namespace {
+    constexpr uint32_t RING_SIZE = 64 * 1024;
+    constexpr uint32_t ROUNDS = 20;
+
+    // UBX_Msg as it was written by hand before ProtocolDescriptor
+    struct UBX_Msg_Handwritten
+    {
+        static constexpr uint32_t BYTE_CONTAINED_LEN = 6;
+        static constexpr uint32_t LEN_OF_SYNC = 2;
+        static constexpr SyncPattern SYNC_PATTERN{{ 0xb5, 0x62 }, { 0xff, 0xff }};
+
+        static uint32_t get_len( const struct ringbuffer& rb)
+        {
+            uint8_t data[2];
+            data[0] = rb.buf[( rb.write_index - 2 ) & rb.size];
+            data[1] = rb.buf[( rb.write_index - 1 ) & rb.size];
+            return *((uint16_t*)data) + 8;
+        }
+
+        static bool get_sync( const struct ringbuffer& rb)
+        {
+            if( rb.buf[( rb.write_index - 1 ) & rb.size] == 0x62  &&
+                rb.buf[( rb.write_index - 2 ) & rb.size] == 0xb5 )
+            {
+                return true;
+            }
+            return false;
+        }
+    };
+
+    std::vector<uint8_t> make_stream()
+    {
+        std::mt19937 gen( 1 );
+        std::vector<uint8_t> stream;
+        while ( stream.size() < RING_SIZE / 2 )
+        {
+            uint32_t payload = gen() % 64;
+            std::vector<uint8_t> msg{ 0xb5, 0x62, 0x01, 0x07, uint8_t( payload ), 0x00 };
+            for ( uint32_t i = 0; i < payload + 2; i++ )
+            {
+                msg.push_back( uint8_t( gen()));
+            }
+            stream.insert( stream.end(), msg.begin(), msg.end());
+            for ( uint32_t i = gen() % 8; i > 0; i-- )
+            {
+                stream.push_back( uint8_t( gen()));
+            }
+        }
+        return stream;
+    }
+
+    template<class Converter>
+    double ns_per_call( const std::vector<uint8_t>& data )
+    {
+        struct ringbuffer rb{ const_cast<uint8_t*>( data.data()), RING_SIZE / 2 - 1, 0, 0 };
+        uint32_t sum{0};
+        auto start = std::chrono::steady_clock::now();
+        for ( uint32_t r = 0; r < ROUNDS; r++ )
+        {
+            for ( uint32_t i = 0; i < RING_SIZE / 2; i++ )
+            {
+                rb.write_index = i;
+                sum += Converter::get_sync( rb ) + Converter::get_len( rb );
+            }
+        }
+        auto spent = std::chrono::steady_clock::now() - start;
+        if ( sum == 0 )
+        {
+            printf( "unexpected sum\n" );
+        }
+        return double( spent.count()) / ( double( RING_SIZE / 2 ) * ROUNDS );
+    }
+
+    template<class Converter>
+    double ns_per_byte( const std::vector<uint8_t>& data )
+    {
+        std::vector<uint8_t> ring( RING_SIZE );
+        std::array<uint8_t, 128> out;
+        StreamSeparator<DummyQueue, Converter, 4096> separator;
+        separator.buffer( ring.data(), RING_SIZE ).create();
+
+        std::chrono::nanoseconds spent{0};
+        for ( uint32_t r = 0; r < ROUNDS; r++ )
+        {
+            auto start = std::chrono::steady_clock::now();
+            for ( uint8_t byte: data )
+            {
+                separator.push( byte );
+            }
+            spent += std::chrono::steady_clock::now() - start;
+            while ( separator.next( out.data(), uint32_t( out.size())) != 0 );
+        }
+        return double( spent.count()) / ( double( data.size()) * ROUNDS );
+    }
+}
+
+int main()
+{
+    auto data = make_stream();
+
+    printf( "%-28s %10s %10s\n", "converter", "ns/call", "ns/byte" );
+    printf( "%-28s %10.3f %10.3f\n", "hand-written",
+            ns_per_call<UBX_Msg_Handwritten>( data ), ns_per_byte<UBX_Msg_Handwritten>( data ));
+    printf( "%-28s %10.3f %10.3f\n", "descriptor",
+            ns_per_call<UBX_Msg>( data ), ns_per_byte<UBX_Msg>( data ));
+    return 0;
+}
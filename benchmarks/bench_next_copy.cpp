@@ -0,0 +1,112 @@
+/**
+ * Microbenchmark of copying msg out of ring-buffer in next():
+ * the former byte-by-byte ringbuffer_get() loop vs. two memcpy segments.
+ *
+ * Every msg is placed to wrap around the end of ring-buffer, so both segments are copied.
+ *
+ * build & run from the root of repo:
+ *  g++ -O2 -std=c++17 -D_UNIT_TEST_ -I. -Itests/test_doubles/ring_buffer \
+ *      benchmarks/bench_next_copy.cpp tests/test_doubles/ring_buffer/utils_ringbuffer.c -o bench_next_copy
+ *  ./bench_next_copy
+ */
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "tests/test_doubles/ring_buffer/utils_ringbuffer.h"
+#include "tests/test_doubles/queue/dummy_queue.hpp"
+#include "tests/test_doubles/ubx_stream_separator.hpp"
+#include "tests/test_doubles/rtos_stubs.hpp"
+
+#include "stream_separator.hpp"
+
+namespace {
+    constexpr uint32_t RING_SIZE = 128 * 1024;
+    std::vector<uint8_t> ring( RING_SIZE );
+
+    std::vector<uint8_t> make_ubx( uint32_t frame_size )
+    {
+        uint32_t payload = frame_size - 8;
+        std::vector<uint8_t> frame( frame_size, 0x5a );
+        frame[0] = 0xb5; frame[1] = 0x62; frame[2] = 0x02; frame[3] = 0x15;
+        frame[4] = uint8_t( payload ); frame[5] = uint8_t( payload >> 8 );
+        return frame;
+    }
+
+    // the body of next() before it was rewritten
+    uint32_t legacy_copy( const StreamFrame& frame, uint8_t* buff_read_to )
+    {
+        struct ringbuffer rb{ ring.data(), RING_SIZE - 1, 0, 0 };
+        rb.read_index = uint32_t( frame.first.data - ring.data());
+        rb.write_index = rb.read_index + frame.length();
+
+        uint32_t was_read{0};
+        while ( was_read < frame.length()) {
+            ringbuffer_get( &rb, &buff_read_to[was_read++]);
+        }
+        return was_read;
+    }
+
+    uint32_t segmented_copy( const StreamFrame& frame, uint8_t* buff_read_to )
+    {
+        memcpy( buff_read_to, frame.first.data, frame.first.size );
+        memcpy( buff_read_to + frame.first.size, frame.second.data, frame.second.size );
+        return frame.length();
+    }
+
+    template<class Copy>
+    double ns_per_msg( const StreamFrame& view, Copy copy )
+    {
+        std::vector<uint8_t> out( view.length());
+        const uint32_t rounds = view.length() < 1024 ? 200000 : 4000;
+        uint32_t checksum{0};
+
+        auto start = std::chrono::steady_clock::now();
+        for ( uint32_t i = 0; i < rounds; i++ )
+        {
+            checksum += copy( view, out.data());
+            checksum += out[view.length() - 1 - i % view.length()];
+        }
+        std::chrono::nanoseconds spent = std::chrono::steady_clock::now() - start;
+
+        if ( checksum == 0 )
+        {
+            printf( "unexpected\n" );
+        }
+        return double( spent.count()) / rounds;
+    }
+}
+
+int main()
+{
+    printf( "%10s %14s %14s %10s %14s\n", "msg_bytes", "loop_ns", "memcpy_ns", "speedup", "memcpy_MB/s" );
+    for ( uint32_t size = 8; size <= 64 * 1024; size *= 2 )
+    {
+        StreamSeparator<DummyQueue, UBX_Msg> separator;
+        separator.buffer( ring.data(), RING_SIZE ).create();
+
+        // noise and empty msg read out, so the msg under test starts before the end of buffer and wraps
+        std::vector<uint8_t> noise( RING_SIZE - size / 2 - 8, 0 );
+        auto empty = make_ubx( 8 );
+        separator.push( noise.data(), noise.size());
+        separator.push( empty.data(), empty.size());
+        uint8_t small[8];
+        separator.next( small, sizeof( small ));
+
+        auto frame = make_ubx( size );
+        separator.push( frame.data(), frame.size());
+        StreamFrame view;
+        if ( !separator.peek_frame( view ) || view.second.size == 0 )
+        {
+            printf( "msg of %u bytes is not wrapped\n", size );
+            return 1;
+        }
+
+        double loop = ns_per_msg( view, legacy_copy );
+        double segmented = ns_per_msg( view, segmented_copy );
+        separator.release_frame();
+
+        printf( "%10u %14.1f %14.1f %9.1fx %14.1f\n", size, loop, segmented, loop / segmented, size / segmented * 1e3 );
+    }
+    return 0;
+}
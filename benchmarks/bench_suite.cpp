@@ -0,0 +1,218 @@
+/**
+ * Throughput and latency of StreamSeparator over synthetic UBX/RTCM3 streams with noise.
+ *
+ * ingest  - push( chunk ) ( DMA callbacks ) and push( byte ) ( IRQ per byte ), ns per byte and MB/s;
+ * consume - next() of all msgs found in chunk, msgs per second;
+ *   swept over frame-size mixes, noise ratios, ring sizes and queue depths, delivered/lost msgs are reported
+ *   to see when the buffer is too small; the queue holds the worst chunk, so descriptors are never lost
+ *   ( otherwise the numbers are of another stream ) and the suite exits with 1 if they are;
+ * latency - from push() by IsrThread to the return of blocking next() in thread, p50/p99/max.
+ *
+ * Every result is printed as one JSON object per line, so it could be collected and compared between changes:
+ *  ./bench_suite > results.jsonl
+ * The rows with lost descriptors are reported to stderr too.
+ *
+ * build & run from the root of repo:
+ *  g++ -O2 -std=c++17 -D_UNIT_TEST_ -I. -Itests/test_doubles/ring_buffer \
+ *      benchmarks/bench_suite.cpp tests/test_doubles/ring_buffer/utils_ringbuffer.c -o bench_suite -pthread
+ *  ./bench_suite
+ */
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "tests/test_doubles/ring_buffer/utils_ringbuffer.h"
+#include "tests/test_doubles/ubx_stream_separator.hpp"
+#include "tests/test_doubles/rtcm3_stream_separator.hpp"
+
+#include "posix_backend.hpp"
+#include "stream_separator.hpp"
+#include "benchmarks/generators.hpp"
+
+namespace {
+    constexpr uint32_t STREAM_BYTES = 4 * 1024 * 1024;
+    constexpr uint32_t CHUNK = 1024;
+    /**
+     * Every byte of chunk could end a descriptor ( rejected false sync is discarded by its own one ), and bytes of
+     * bogus msg received before the chunk are searched again for sync in it ( see tools/parallel_splitter.hpp ).
+     */
+    constexpr uint32_t MIN_QUEUE_DEPTH = 2 * CHUNK;
+    constexpr uint32_t LATENCY_FRAMES = 2000;
+
+    const bench::FrameMix MIXES[] = {
+        { "ubx_small",  8,   32,   0.0 },
+        { "mixed",      8,   512,  0.3 },
+        { "rtcm_large", 256, 1000, 1.0 },
+    };
+    const double NOISE_RATIOS[] = { 0.0, 0.1, 0.5 };
+    const uint32_t RING_SIZES[] = { 4096, 65536 };
+
+    template<uint32_t QUEUE_DEPTH>
+    using Separator = StreamSeparator<PosixQueue, AnyOf<UBX_Checked_Msg, RTCM_Msg>, QUEUE_DEPTH>;
+
+    using Clock = std::chrono::steady_clock;
+
+    double ns( Clock::duration d )
+    {
+        return double( std::chrono::duration_cast<std::chrono::nanoseconds>( d ).count());
+    }
+
+    /** the row is not comparable with others if descriptors were lost, it's reported to stderr */
+    bool lossless( const char* bench, const bench::FrameMix& mix, double noise_ratio, uint32_t ring_size,
+                   uint32_t queue_depth, const StreamStats& stats )
+    {
+        if ( stats.queue_full != 0 )
+        {
+            fprintf( stderr, "%s mix %s noise %.2f ring %u queue %u: %u descriptors lost on full queue\n",
+                     bench, mix.name, noise_ratio, ring_size, queue_depth, stats.queue_full );
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * the stream is pushed in chunks, all msgs are read out after every chunk
+     * @return false if descriptors were lost on full queue.
+     */
+    template<uint32_t QUEUE_DEPTH>
+    bool ingest_and_consume( const bench::FrameMix& mix, double noise_ratio, uint32_t ring_size,
+                             const bench::Stream& stream )
+    {
+        static_assert( QUEUE_DEPTH >= MIN_QUEUE_DEPTH, "queue has to hold descriptors of the worst chunk" );
+
+        std::vector<uint8_t> ring( ring_size );
+        std::vector<uint8_t> out( 2048 );
+        Separator<QUEUE_DEPTH> separator;
+        separator.buffer( ring.data(), ring_size ).create();
+
+        Clock::duration push_time{};
+        Clock::duration next_time{};
+        uint32_t delivered{0};
+        for ( size_t i = 0; i < stream.bytes.size(); i += CHUNK )
+        {
+            size_t len = std::min<size_t>( CHUNK, stream.bytes.size() - i );
+            auto start = Clock::now();
+            separator.push( &stream.bytes[i], len );
+            auto pushed = Clock::now();
+            while ( separator.next( out.data(), uint32_t( out.size())) != 0 )
+            {
+                delivered++;
+            }
+            next_time += Clock::now() - pushed;
+            push_time += pushed - start;
+        }
+        StreamStats stats = separator.stats();
+
+        printf( "{\"bench\":\"ingest_consume\",\"mix\":\"%s\",\"noise\":%.2f,\"ring\":%u,\"queue\":%u,\"chunk\":%u,"
+                "\"push_ns_per_byte\":%.3f,\"push_MB_per_s\":%.1f,\"next_ns_per_msg\":%.1f,\"msgs_per_s\":%.0f,"
+                "\"frames\":%u,\"delivered\":%u,\"queue_full\":%u,\"missed_chars\":%u}\n",
+                mix.name, noise_ratio, ring_size, QUEUE_DEPTH, CHUNK,
+                ns( push_time ) / double( stream.bytes.size()), double( stream.bytes.size()) / ns( push_time ) * 1e3,
+                delivered ? ns( next_time ) / delivered : 0.0, delivered ? delivered / ns( next_time ) * 1e9 : 0.0,
+                stream.frames, delivered, stats.queue_full, stats.missed_chars );
+        return lossless( "ingest_consume", mix, noise_ratio, ring_size, QUEUE_DEPTH, stats );
+    }
+
+    /** IRQ per byte, the buffer is read out after every CHUNK bytes */
+    bool isr_per_byte( const bench::FrameMix& mix, double noise_ratio, const bench::Stream& stream )
+    {
+        constexpr uint32_t ring_size = 65536;
+        std::vector<uint8_t> ring( ring_size );
+        std::vector<uint8_t> out( 2048 );
+        Separator<MIN_QUEUE_DEPTH> separator;
+        separator.buffer( ring.data(), ring_size ).create();
+
+        Clock::duration push_time{};
+        for ( size_t i = 0; i < stream.bytes.size(); i += CHUNK )
+        {
+            size_t end = std::min<size_t>( i + CHUNK, stream.bytes.size());
+            auto start = Clock::now();
+            for ( size_t j = i; j < end; j++ )
+            {
+                separator.push( stream.bytes[j] );
+            }
+            push_time += Clock::now() - start;
+            while ( separator.next( out.data(), uint32_t( out.size())) != 0 );
+        }
+
+        StreamStats stats = separator.stats();
+
+        printf( "{\"bench\":\"isr_per_byte\",\"mix\":\"%s\",\"noise\":%.2f,\"ring\":%u,\"queue\":%u,"
+                "\"push_ns_per_byte\":%.3f,\"push_MB_per_s\":%.1f,\"queue_full\":%u}\n",
+                mix.name, noise_ratio, ring_size, MIN_QUEUE_DEPTH,
+                ns( push_time ) / double( stream.bytes.size()), double( stream.bytes.size()) / ns( push_time ) * 1e3,
+                stats.queue_full );
+        return lossless( "isr_per_byte", mix, noise_ratio, ring_size, MIN_QUEUE_DEPTH, stats );
+    }
+
+    /** every msg carries the time it was pushed at in its payload */
+    void latency()
+    {
+        std::vector<uint8_t> ring( 65536 );
+        std::array<uint8_t, 64> out;
+        Separator<256> separator;
+        separator.buffer( ring.data(), uint32_t( ring.size())).set_timeout( 1000 ).create();
+
+        bench::Generator gen;
+        uint32_t sent{0};
+        IsrThread irq( separator, [&]( uint8_t* buf, size_t ) -> size_t
+        {
+            if ( sent++ == LATENCY_FRAMES )
+            {
+                return 0;
+            }
+            std::this_thread::sleep_for( std::chrono::microseconds( 100 ));
+            auto msg = gen.ubx( 16 );
+            int64_t now = Clock::now().time_since_epoch().count();
+            memcpy( &msg[6], &now, sizeof( now ));
+            struct ringbuffer rb{ msg.data(), 0xFFFFFFFFU, 0, uint32_t( msg.size()) };
+            uint16_t ck = fletcher8( rb, 2, uint32_t( msg.size()) - 4 );
+            msg[msg.size() - 2] = uint8_t( ck );
+            msg[msg.size() - 1] = uint8_t( ck >> 8 );
+            memcpy( buf, msg.data(), msg.size());
+            return msg.size();
+        });
+
+        std::vector<double> latencies;
+        while ( latencies.size() < LATENCY_FRAMES && separator.next( out.data(), uint32_t( out.size())) != 0 )
+        {
+            int64_t pushed;
+            memcpy( &pushed, &out[6], sizeof( pushed ));
+            latencies.push_back( ns( Clock::duration( Clock::now().time_since_epoch().count() - pushed )));
+        }
+        irq.join();
+        if ( latencies.empty())
+        {
+            return;
+        }
+
+        std::sort( latencies.begin(), latencies.end());
+        auto percentile = [&]( double p ) { return latencies[size_t( p * double( latencies.size() - 1 ))] / 1e3; };
+        printf( "{\"bench\":\"latency\",\"frames\":%zu,\"p50_us\":%.1f,\"p99_us\":%.1f,\"max_us\":%.1f}\n",
+                latencies.size(), percentile( 0.5 ), percentile( 0.99 ), latencies.back() / 1e3 );
+    }
+}
+
+int main()
+{
+    bool ok{ true };
+    for ( const auto& mix: MIXES )
+    {
+        for ( double noise_ratio: NOISE_RATIOS )
+        {
+            bench::Generator gen;
+            bench::Stream stream = gen.stream( mix, noise_ratio, STREAM_BYTES );
+            for ( uint32_t ring_size: RING_SIZES )
+            {
+                ok &= ingest_and_consume<MIN_QUEUE_DEPTH>( mix, noise_ratio, ring_size, stream );
+                ok &= ingest_and_consume<4 * MIN_QUEUE_DEPTH>( mix, noise_ratio, ring_size, stream );
+            }
+            ok &= isr_per_byte( mix, noise_ratio, stream );
+        }
+    }
+    latency();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,117 @@
+/**
+ * Throughput of looking for sync word in noise:
+ * - search kernels of sync_scanner.hpp over the noise without candidates;
+ * - push( data, len ) of noise into StreamSeparator with SYNC_PATTERN ( vectorized scan )
+ *   and without it ( get_sync() after every byte ).
+ *
+ * build & run from the root of repo ( -mavx2 enables AVX2 kernel ):
+ *  g++ -O2 -mavx2 -std=c++17 -D_UNIT_TEST_ -I. -Itests/test_doubles/ring_buffer \
+ *      benchmarks/bench_sync_scan.cpp tests/test_doubles/ring_buffer/utils_ringbuffer.c -o bench_sync_scan
+ *  ./bench_sync_scan
+ */
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "tests/test_doubles/ring_buffer/utils_ringbuffer.h"
+#include "tests/test_doubles/queue/dummy_queue.hpp"
+#include "tests/test_doubles/ubx_stream_separator.hpp"
+#include "tests/test_doubles/rtos_stubs.hpp"
+
+#include "stream_separator.hpp"
+
+namespace {
+    constexpr size_t NOISE_SIZE = 4 * 1024 * 1024;
+    constexpr uint32_t ROUNDS = 50;
+
+    // the same as UBX_Msg, but without SYNC_PATTERN
+    struct UBX_Msg_Bytewise
+    {
+        static constexpr uint32_t BYTE_CONTAINED_LEN = UBX_Msg::BYTE_CONTAINED_LEN;
+        static constexpr uint32_t LEN_OF_SYNC = UBX_Msg::LEN_OF_SYNC;
+        static uint32_t get_len( const struct ringbuffer& rb ) { return UBX_Msg::get_len( rb ); }
+        static bool get_sync( const struct ringbuffer& rb ) { return UBX_Msg::get_sync( rb ); }
+    };
+
+    std::vector<uint8_t> make_noise()
+    {
+        std::mt19937 gen( 1 );
+        std::vector<uint8_t> noise( NOISE_SIZE );
+        for ( auto& byte: noise )
+        {
+            do {
+                byte = uint8_t( gen());
+            } while ( byte == 0xb5 );
+        }
+        return noise;
+    }
+
+    double gb_per_s( size_t bytes, std::chrono::nanoseconds spent )
+    {
+        return double( bytes ) / double( spent.count());
+    }
+
+    template<class Find>
+    double scan( const std::vector<uint8_t>& noise, Find find )
+    {
+        size_t found{0};
+        auto start = std::chrono::steady_clock::now();
+        for ( uint32_t i = 0; i < ROUNDS; i++ )
+        {
+            found += find( noise.data(), noise.size(), UBX_Msg::SYNC_PATTERN );
+        }
+        auto spent = std::chrono::steady_clock::now() - start;
+        if ( found != noise.size() * ROUNDS )
+        {
+            printf( "unexpected candidate\n" );
+        }
+        return gb_per_s( noise.size() * ROUNDS, spent );
+    }
+
+    template<class Converter>
+    double push_noise( const std::vector<uint8_t>& noise )
+    {
+        std::vector<uint8_t> ring( NOISE_SIZE * 2 );
+        StreamSeparator<DummyQueue, Converter> separator;
+        separator.buffer( ring.data(), uint32_t( ring.size())).create();
+
+        const std::array<uint8_t, 8> empty{ 0xb5, 0x62, 0x01, 0x02, 0x00, 0x00, 0x03, 0x0a };
+        std::array<uint8_t, 8> out;
+        std::chrono::nanoseconds spent{0};
+        for ( uint32_t i = 0; i < ROUNDS; i++ )
+        {
+            auto start = std::chrono::steady_clock::now();
+            separator.push( noise.data(), noise.size());
+            spent += std::chrono::steady_clock::now() - start;
+
+            // the msg after noise makes it discarded
+            separator.push( empty.data(), empty.size());
+            if ( separator.next( out.data(), uint32_t( out.size())) != int32_t( empty.size()))
+            {
+                printf( "msg after noise is not found\n" );
+            }
+        }
+        return gb_per_s( noise.size() * ROUNDS, spent );
+    }
+}
+
+int main()
+{
+    auto noise = make_noise();
+
+    printf( "%-28s %8s\n", "noise_scan", "GB/s" );
+    printf( "%-28s %8.2f\n", "find_scalar", scan( noise, []( const uint8_t* d, size_t l, const SyncPattern& p ) {
+        return sync_scanner::find_scalar( d, l, p );
+    }));
+#if defined( __SSE2__ )
+    printf( "%-28s %8.2f\n", "find_sse2", scan( noise, sync_scanner::find_sse2 ));
+#endif
+#if defined( __AVX2__ )
+    printf( "%-28s %8.2f\n", "find_avx2", scan( noise, sync_scanner::find_avx2 ));
+#endif
+    printf( "%-28s %8.2f\n", "push_bytewise_get_sync", push_noise<UBX_Msg_Bytewise>( noise ));
+    printf( "%-28s %8.2f\n", "push_sync_pattern", push_noise<UBX_Msg>( noise ));
+    return 0;
+}
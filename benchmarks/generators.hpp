@@ -0,0 +1,109 @@
+/**
+ * Synthetic streams for benchmarks: valid UBX ( Fletcher-8 ) and RTCM3 ( CRC-24Q ) msgs of given payload sizes
+ * mixed with noise. Noise does not contain the first bytes of sync words, so every generated msg is expected
+ * to be found and nothing else.
+ */
+#ifndef __BENCH_GENERATORS__
+#define __BENCH_GENERATORS__
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "checksum.hpp"
+
+namespace bench {
+
+/** payload size is uniform in [min_payload, max_payload], rtcm_share of msgs are RTCM3, the rest UBX */
+struct FrameMix
+{
+    const char* name;
+    uint32_t min_payload;
+    uint32_t max_payload;
+    double rtcm_share;
+};
+
+struct Stream
+{
+    std::vector<uint8_t> bytes;
+    uint32_t frames{0};
+    uint32_t frame_bytes{0};
+};
+
+class Generator
+{
+public:
+    explicit Generator( uint32_t seed = 1 ): gen{ seed } {};
+
+    std::vector<uint8_t> ubx( uint32_t payload )
+    {
+        std::vector<uint8_t> msg{ 0xb5, 0x62, 0x02, 0x15, uint8_t( payload ), uint8_t( payload >> 8 )};
+        random_bytes( msg, payload );
+        struct ringbuffer rb{ msg.data(), 0xFFFFFFFFU, 0, uint32_t( msg.size()) };
+        uint16_t ck = fletcher8( rb, 2, uint32_t( msg.size()) - 2 );
+        msg.push_back( uint8_t( ck ));
+        msg.push_back( uint8_t( ck >> 8 ));
+        return msg;
+    }
+
+    std::vector<uint8_t> rtcm( uint32_t payload )
+    {
+        payload &= 0x3FF;
+        std::vector<uint8_t> msg{ 0xd3, uint8_t( payload >> 8 ), uint8_t( payload )};
+        random_bytes( msg, payload );
+        struct ringbuffer rb{ msg.data(), 0xFFFFFFFFU, 0, uint32_t( msg.size()) };
+        uint32_t crc = crc24q( rb, 0, uint32_t( msg.size()));
+        msg.push_back( uint8_t( crc >> 16 ));
+        msg.push_back( uint8_t( crc >> 8 ));
+        msg.push_back( uint8_t( crc ));
+        return msg;
+    }
+
+    void noise( std::vector<uint8_t>& out, uint32_t len )
+    {
+        for ( uint32_t i = 0; i < len; i++ )
+        {
+            uint8_t byte;
+            do {
+                byte = uint8_t( gen());
+            } while ( byte == 0xb5 || byte == 0xd3 );
+            out.push_back( byte );
+        }
+    }
+
+    /** about total bytes of msgs of mix, noise_ratio of bytes are noise placed between msgs */
+    Stream stream( const FrameMix& mix, double noise_ratio, uint32_t total )
+    {
+        Stream s;
+        std::uniform_int_distribution<uint32_t> payload( mix.min_payload, mix.max_payload );
+        std::bernoulli_distribution is_rtcm( mix.rtcm_share );
+        double noise_debt{0};
+        while ( s.bytes.size() < total )
+        {
+            auto msg = is_rtcm( gen ) ? rtcm( payload( gen )) : ubx( payload( gen ));
+            s.bytes.insert( s.bytes.end(), msg.begin(), msg.end());
+            s.frames++;
+            s.frame_bytes += uint32_t( msg.size());
+
+            noise_debt += double( msg.size()) * noise_ratio / ( 1.0 - noise_ratio );
+            noise( s.bytes, uint32_t( noise_debt ));
+            noise_debt -= uint32_t( noise_debt );
+        }
+        return s;
+    }
+
+private:
+    void random_bytes( std::vector<uint8_t>& out, uint32_t len )
+    {
+        for ( uint32_t i = 0; i < len; i++ )
+        {
+            out.push_back( uint8_t( gen()));
+        }
+    }
+
+    std::mt19937 gen;
+};
+
+} // namespace bench
+
+#endif //__BENCH_GENERATORS__
@@ -0,0 +1,105 @@
+/**
+ * @author m-chichikalov@outlook.com
+ *
+ * @license  This is free chunk of code, you can do with it whatever you want;
+ *           There is no any warranty and it's posted in the hope that it will be useful.
+ *
+ * @brief Checksums of msgs located in the ring-buffer, to be used by StreamConverter::verify().
+ *
+ * index is the index of the first byte in ring-buffer ( not masked ), msg could wrap around the end of buffer.
+ *
+ * fletcher8( rb, index, len ) - 8-bit Fletcher used by UBX, returns CK_A in low byte and CK_B in high one.
+ * crc24q( rb, index, len )    - CRC-24Q used by RTCM3 ( poly 0x1864CFB, init 0 ).
+ * xor8( rb, index, len )      - XOR of all bytes used by NMEA-0183.
+ */
+
+#ifndef __STREAM_CHECKSUM__
+#define __STREAM_CHECKSUM__
+
+#include <array>
+#include <cstdint>
+
+#include "utils_ringbuffer.h"
+
+namespace checksum_detail {
+    /** calls f( data, size ) for one or two contiguous parts of msg */
+    template<class F>
+    inline void for_each_segment( const struct ringbuffer& rb, uint32_t index, uint32_t len, F f )
+    {
+        uint32_t offset = index & rb.size;
+        uint32_t first = rb.size + 1 - offset;
+        if ( first > len )
+        {
+            first = len;
+        }
+        f( &rb.buf[offset], first );
+        if ( len != first )
+        {
+            f( rb.buf, len - first );
+        }
+    }
+
+    constexpr std::array<uint32_t, 256> make_crc24q_table()
+    {
+        std::array<uint32_t, 256> table{};
+        for ( uint32_t i = 0; i < 256; i++ )
+        {
+            uint32_t crc = i << 16;
+            for ( uint32_t bit = 0; bit < 8; bit++ )
+            {
+                crc <<= 1;
+                if ( crc & 0x1000000U )
+                {
+                    crc ^= 0x1864CFBU;
+                }
+            }
+            table[i] = crc & 0xFFFFFFU;
+        }
+        return table;
+    }
+
+    inline constexpr std::array<uint32_t, 256> crc24q_table = make_crc24q_table();
+}
+
+inline uint16_t fletcher8( const struct ringbuffer& rb, uint32_t index, uint32_t len )
+{
+    uint8_t ck_a{0};
+    uint8_t ck_b{0};
+    checksum_detail::for_each_segment( rb, index, len, [&]( const uint8_t* data, uint32_t size )
+    {
+        for ( uint32_t i = 0; i < size; i++ )
+        {
+            ck_a += data[i];
+            ck_b += ck_a;
+        }
+    });
+    return uint16_t( ck_a | ( ck_b << 8 ));
+}
+
+inline uint32_t crc24q( const struct ringbuffer& rb, uint32_t index, uint32_t len )
+{
+    uint32_t crc{0};
+    checksum_detail::for_each_segment( rb, index, len, [&]( const uint8_t* data, uint32_t size )
+    {
+        for ( uint32_t i = 0; i < size; i++ )
+        {
+            crc = (( crc << 8 ) & 0xFFFFFFU ) ^ checksum_detail::crc24q_table[( crc >> 16 ) ^ data[i]];
+        }
+    });
+    return crc;
+}
+
+inline uint8_t xor8( const struct ringbuffer& rb, uint32_t index, uint32_t len )
+{
+    uint8_t sum{0};
+    checksum_detail::for_each_segment( rb, index, len, [&]( const uint8_t* data, uint32_t size )
+    {
+        for ( uint32_t i = 0; i < size; i++ )
+        {
+            sum ^= data[i];
+        }
+    });
+    return sum;
+}
+
+#endif //__STREAM_CHECKSUM__
@@ -0,0 +1,365 @@
+/**
+ * @author m-chichikalov@outlook.com
+ *
+ * @license  This is free chunk of code, you can do with it whatever you want;
+ *           There is no any warranty and it's posted in the hope that it will be useful.
+ *
+ * @brief C++20 coroutine interface of StreamSeparator on Linux host ( on top of posix_backend.hpp ).
+ *
+ * AsyncQueue - CQueue which, besides blocking Dequeue(), resumes the coroutine waiting for msg.
+ * With it separator.async_next( executor ) is awaitable: co_await suspends the coroutine until the msg
+ * is queued by IRQ ( IsrThread ), then the coroutine is resumed by executor.post( handle ) on the executor
+ * of caller, not on IRQ thread. The result is FrameView, it's empty only if buffer was flushed meanwhile.
+ *
+ * frames( separator, executor ) is the async generator of msgs: while ( auto view = co_await msgs.next()) { ... }
+ * The previous view has to be destroyed ( msg released ) before the next one is awaited.
+ *
+ * Executor is anything with thread safe void post( std::coroutine_handle<> ), LoopExecutor is the simple one.
+ *
+ *  @example
+ *  StreamSeparator<AsyncQueue, UBX_Msg> port;
+ *
+ *  Detached serve( StreamSeparator<AsyncQueue, UBX_Msg>& port, LoopExecutor& loop )
+ *  {
+ *      auto msgs = frames( port, loop );
+ *      while ( auto view = co_await msgs.next())
+ *      {
+ *          decode( *view );
+ *      }
+ *  }
+ */
+
+#ifndef __COROUTINE_BACKEND__
+#define __COROUTINE_BACKEND__
+
+#if __cplusplus >= 202002L && defined( __cpp_impl_coroutine )
+
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <utility>
+
+#include "posix_backend.hpp"
+
+/**
+ * StreamSeparator uses CQueue as binary semaphore, so only the presence of token is kept.
+ * The waiting coroutine takes precedence over the token, it's resumed instead of storing the token.
+ */
+class AsyncQueue
+{
+public:
+    static constexpr uint32_t WAIT_FOREVER = 0xFFFFFFFFU;
+
+    AsyncQueue( size_t, size_t ) {};
+
+    bool Enqueue( void* )
+    {
+        std::coroutine_handle<> waiter;
+        void ( *post )( void*, std::coroutine_handle<> ){ nullptr };
+        void* executor{ nullptr };
+        {
+            std::lock_guard<std::mutex> lock( mutex );
+            if ( this->waiter )
+            {
+                std::swap( waiter, this->waiter );
+                post = this->post;
+                executor = this->executor;
+            }
+            else
+            {
+                token = true;
+            }
+        }
+        if ( waiter )
+        {
+            post( executor, waiter );
+        }
+        else
+        {
+            has_token.notify_one();
+        }
+        return true;
+    };
+    bool Enqueue( void* item, uint32_t ) { return Enqueue( item ); };
+    bool EnqueueFromISR( void* item, BaseType_t* pxHigherPriorityTaskWoken )
+    {
+        if ( pxHigherPriorityTaskWoken )
+        {
+            *pxHigherPriorityTaskWoken = false;
+        }
+        return Enqueue( item );
+    };
+
+    /** blocking wait for the thread which does not use coroutines */
+    bool Dequeue( void*, uint32_t timeout )
+    {
+        std::unique_lock<std::mutex> lock( mutex );
+        auto ready = [this]{ return token; };
+        if ( timeout == WAIT_FOREVER )
+        {
+            has_token.wait( lock, ready );
+        }
+        else if ( timeout == 0 )
+        {
+            if ( !ready())
+            {
+                return false;
+            }
+        }
+        else if ( !has_token.wait_for( lock, std::chrono::milliseconds( timeout ), ready ))
+        {
+            return false;
+        }
+        token = false;
+        return true;
+    };
+    bool Dequeue( void* item ) { return Dequeue( item, WAIT_FOREVER ); };
+
+    void Flush()
+    {
+        std::lock_guard<std::mutex> lock( mutex );
+        token = false;
+    };
+
+    /**
+     * Takes the token if there is one ( returns false ), otherwise h is posted to executor
+     * when the token arrives. Only one coroutine could wait at time.
+     */
+    template<class Executor>
+    bool arm( std::coroutine_handle<> h, Executor& executor_ )
+    {
+        std::lock_guard<std::mutex> lock( mutex );
+        if ( token )
+        {
+            token = false;
+            return false;
+        }
+        waiter = h;
+        executor = &executor_;
+        post = []( void* e, std::coroutine_handle<> handle ) { static_cast<Executor*>( e )->post( handle ); };
+        return true;
+    }
+
+    template<class Separator, class Executor>
+    auto async_wait( Separator& separator, Executor& executor );
+
+private:
+    std::mutex mutex;
+    std::condition_variable has_token;
+    bool token{ false };
+    std::coroutine_handle<> waiter;
+    void* executor{ nullptr };
+    void ( *post )( void*, std::coroutine_handle<> ){ nullptr };
+};
+
+/** awaitable returned by separator.async_next( executor ), msgs are only polled, timeout of separator is not waited */
+template<class Separator, class Executor>
+class NextFrameAwaitable
+{
+public:
+    NextFrameAwaitable( Separator& separator_, AsyncQueue& queue_, Executor& executor_ ):
+        separator{ separator_ }, queue{ queue_ }, executor{ executor_ }, view{ separator_.try_next_frame()}
+    {};
+
+    bool await_ready() const { return bool( view ); }
+
+    bool await_suspend( std::coroutine_handle<> h )
+    {
+        // the token could be stale ( msgs were taken without waiting ), so check again after taking it
+        while ( !queue.arm( h, executor ))
+        {
+            view = separator.try_next_frame();
+            if ( view )
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    typename Separator::FrameView await_resume()
+    {
+        if ( !view )
+        {
+            view = separator.try_next_frame();
+        }
+        return std::move( view );
+    }
+
+private:
+    Separator& separator;
+    AsyncQueue& queue;
+    Executor& executor;
+    typename Separator::FrameView view;
+};
+
+template<class Separator, class Executor>
+auto AsyncQueue::async_wait( Separator& separator, Executor& executor )
+{
+    return NextFrameAwaitable<Separator, Executor>{ separator, *this, executor };
+}
+
+/** resumes coroutines posted from any thread on the thread calling run() */
+class LoopExecutor
+{
+public:
+    void post( std::coroutine_handle<> h )
+    {
+        {
+            std::lock_guard<std::mutex> lock( mutex );
+            ready.push_back( h );
+        }
+        not_empty.notify_one();
+    }
+
+    /** resumes posted coroutines until stop() */
+    void run()
+    {
+        for ( ;; )
+        {
+            std::coroutine_handle<> h;
+            {
+                std::unique_lock<std::mutex> lock( mutex );
+                not_empty.wait( lock, [this]{ return stopped || !ready.empty(); });
+                if ( ready.empty())
+                {
+                    stopped = false;
+                    return;
+                }
+                h = ready.front();
+                ready.pop_front();
+            }
+            h.resume();
+        }
+    }
+
+    /** run() returns when all posted coroutines are resumed */
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock( mutex );
+            stopped = true;
+        }
+        not_empty.notify_one();
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable not_empty;
+    std::deque<std::coroutine_handle<>> ready;
+    bool stopped{ false };
+};
+
+/** coroutine started at once and destroyed at the end, nobody waits for it */
+struct Detached
+{
+    struct promise_type
+    {
+        Detached get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+/**
+ * Async generator: co_await next() resumes the generator until it co_yields the value ( or returns ),
+ * the value is moved out to the awaiting coroutine, empty T is returned when generator is finished.
+ */
+template<class T>
+class AsyncGenerator
+{
+public:
+    struct promise_type
+    {
+        T* value{ nullptr };
+        std::coroutine_handle<> consumer;
+
+        struct YieldAwaiter
+        {
+            bool await_ready() noexcept { return false; }
+            std::coroutine_handle<> await_suspend( std::coroutine_handle<promise_type> h ) noexcept
+            {
+                return h.promise().consumer;
+            }
+            void await_resume() noexcept {}
+        };
+
+        AsyncGenerator get_return_object()
+        {
+            return AsyncGenerator{ std::coroutine_handle<promise_type>::from_promise( *this )};
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        YieldAwaiter final_suspend() noexcept
+        {
+            value = nullptr;
+            return {};
+        }
+        YieldAwaiter yield_value( T& value_ ) noexcept
+        {
+            value = &value_;
+            return {};
+        }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    AsyncGenerator( AsyncGenerator&& other ): coroutine{ std::exchange( other.coroutine, nullptr )} {};
+    AsyncGenerator( const AsyncGenerator& ) = delete;
+    AsyncGenerator& operator=( const AsyncGenerator& ) = delete;
+    ~AsyncGenerator()
+    {
+        if ( coroutine )
+        {
+            coroutine.destroy();
+        }
+    }
+
+    auto next()
+    {
+        struct NextAwaiter
+        {
+            std::coroutine_handle<promise_type> coroutine;
+
+            bool await_ready() noexcept { return coroutine.done(); }
+            std::coroutine_handle<> await_suspend( std::coroutine_handle<> consumer ) noexcept
+            {
+                coroutine.promise().consumer = consumer;
+                return coroutine;
+            }
+            T await_resume()
+            {
+                if ( coroutine.done() || !coroutine.promise().value )
+                {
+                    return T{};
+                }
+                return std::move( *coroutine.promise().value );
+            }
+        };
+        return NextAwaiter{ coroutine };
+    }
+
+private:
+    explicit AsyncGenerator( std::coroutine_handle<promise_type> coroutine_ ): coroutine{ coroutine_ } {};
+
+    std::coroutine_handle<promise_type> coroutine;
+};
+
+/** endless stream of msgs of separator, the generator is suspended while there is no msgs */
+template<class Separator, class Executor>
+AsyncGenerator<typename Separator::FrameView> frames( Separator& separator, Executor& executor )
+{
+    for ( ;; )
+    {
+        auto view = co_await separator.async_next( executor );
+        if ( view )
+        {
+            co_yield view;
+        }
+    }
+}
+
+#endif // C++20 coroutines
+
+#endif //__COROUTINE_BACKEND__
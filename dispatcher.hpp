@@ -0,0 +1,182 @@
+/**
+ * @author m-chichikalov@outlook.com
+ *
+ * @license  This is free chunk of code, you can do with it whatever you want;
+ *           There is no any warranty and it's posted in the hope that it will be useful.
+ *
+ * @brief Calls handler of msg by its key ( e.g. UBX class/ID, RTCM3 msg number ) instead of switch after next().
+ *
+ * Dispatcher<StreamConverter, Handlers...> takes the key of msg by StreamConverter::get_key() ( see BYTE_CONTAINED_KEY
+ * and protocol_descriptor.hpp ), finds it by binary search in the table of handlers sorted by their KEY at compile time
+ * and calls the handler with zero-copy StreamFrame, so dispatch costs one lookup and one indirect call.
+ *
+ * Every handler provides static constexpr uint32_t KEY and void operator()( const StreamFrame& ), keys have to be
+ * unique. Handlers are kept by dispatcher ( see handler<Handler>() ), so they could have their own state.
+ * Dispatcher is a sink of next_batch(), poll( stream, max_frames ) passes msgs of StreamConverter from
+ * the separator ( single or MultiStreamSeparator ) to handlers. Msgs without handler are only counted by unhandled().
+ *
+ *  @example
+ *  struct OnNavPvt
+ *  {
+ *      static constexpr uint32_t KEY = 0x0107;
+ *      void operator()( const StreamFrame& frame ) { ... }
+ *  };
+ *  struct OnRawx
+ *  {
+ *      static constexpr uint32_t KEY = 0x0215;
+ *      void operator()( const StreamFrame& frame ) { ... }
+ *  };
+ *
+ *  Dispatcher<UBX_Msg, OnNavPvt, OnRawx> dispatcher;
+ *  while ( true )
+ *  {
+ *      dispatcher.poll( ubx_stream, 16 );
+ *  }
+ */
+
+#ifndef __DISPATCHER__
+#define __DISPATCHER__
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <tuple>
+#include <utility>
+
+#include "utils_ringbuffer.h"
+#include "stream_separator.hpp"
+
+template<class StreamConverter, class... Handlers>
+class Dispatcher
+{
+    static_assert( stream_separator_detail::key_position_of<StreamConverter>() != 0, "StreamConverter has no key" );
+    static_assert( sizeof...( Handlers ) != 0, "Dispatcher needs at least one handler" );
+
+    static constexpr uint32_t KEY_POSITION = stream_separator_detail::key_position_of<StreamConverter>();
+    /** the first bytes of msg are copied to take its key, ring-buffer of them has to be power of 2 */
+    static constexpr uint32_t KEY_BUFFER = [] {
+        uint32_t size{1};
+        while ( size < KEY_POSITION )
+        {
+            size <<= 1;
+        }
+        return size;
+    }();
+
+    using Handle = void (*)( Dispatcher& self, const StreamFrame& frame );
+
+    struct Entry
+    {
+        uint32_t key;
+        Handle handle;
+    };
+
+public:
+    Dispatcher() = default;
+    explicit Dispatcher( Handlers... handlers_ ): handlers{ std::move( handlers_ )... } {};
+
+    /** Calls handler of msg. @return false if there is no handler for key of msg. */
+    bool operator()( const StreamFrame& frame )
+    {
+        // the class is complete only inside of its member functions
+        static constexpr std::array<Entry, sizeof...( Handlers )> TABLE = sorted( std::index_sequence_for<Handlers...>{});
+        static_assert( unique( TABLE ), "KEY of handlers has to be unique" );
+
+        if ( frame.length() >= KEY_POSITION )
+        {
+            uint32_t key = key_of( frame );
+            const Entry* entry = std::lower_bound( TABLE.begin(), TABLE.end(), key,
+                                                   []( const Entry& e, uint32_t k ) { return e.key < k; });
+            if ( entry != TABLE.end() && entry->key == key )
+            {
+                entry->handle( *this, frame );
+                return true;
+            }
+        }
+        unhandled_frames++;
+        return false;
+    }
+
+    /**
+     * Blocks for the first msg of stream the same way as next(), then passes every msg already in queue
+     * ( up to max_frames ) to its handler. Msgs of other converters of MultiStreamSeparator are skipped.
+     * @return the number of msgs taken from stream.
+     */
+    template<class Separator>
+    uint32_t poll( Separator& stream, uint32_t max_frames )
+    {
+        auto sink = [this]( const StreamFrame& frame )
+        {
+            if ( frame.protocol == Separator::template protocol_id<StreamConverter>())
+            {
+                ( *this )( frame );
+            }
+        };
+        return stream.next_batch( sink, max_frames );
+    }
+
+    template<class Handler>
+    Handler& handler()
+    {
+        return std::get<Handler>( handlers );
+    }
+
+    /** msgs of StreamConverter passed to dispatcher without handler of their key */
+    uint32_t unhandled() const
+    {
+        return unhandled_frames;
+    }
+
+private:
+    std::tuple<Handlers...> handlers;
+    uint32_t unhandled_frames{0};
+
+    template<size_t I>
+    static void call( Dispatcher& self, const StreamFrame& frame )
+    {
+        std::get<I>( self.handlers )( frame );
+    }
+
+    template<size_t... I>
+    static constexpr std::array<Entry, sizeof...( Handlers )> sorted( std::index_sequence<I...> )
+    {
+        std::array<Entry, sizeof...( Handlers )> table{{ { Handlers::KEY, &call<I> }... }};
+        // insertion sort, std::sort is not constexpr in C++17
+        for ( size_t i = 1; i < table.size(); i++ )
+        {
+            for ( size_t j = i; j > 0 && table[j].key < table[j - 1].key; j-- )
+            {
+                Entry entry = table[j];
+                table[j] = table[j - 1];
+                table[j - 1] = entry;
+            }
+        }
+        return table;
+    }
+
+    static constexpr bool unique( const std::array<Entry, sizeof...( Handlers )>& table )
+    {
+        for ( size_t i = 1; i < table.size(); i++ )
+        {
+            if ( table[i].key == table[i - 1].key )
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /** get_key() reads the last received bytes, so the first bytes of msg are put into ring-buffer of their own */
+    static uint32_t key_of( const StreamFrame& frame )
+    {
+        uint8_t head[KEY_BUFFER];
+        for ( uint32_t i = 0; i < KEY_POSITION; i++ )
+        {
+            head[i] = frame[i];
+        }
+        const struct ringbuffer rb{ head, KEY_BUFFER - 1, 0, KEY_POSITION };
+        return uint32_t( StreamConverter::get_key( rb ));
+    }
+};
+
+#endif //__DISPATCHER__
@@ -0,0 +1,94 @@
+/**
+ * @author m-chichikalov@outlook.com
+ *
+ * @license  This is free chunk of code, you can do with it whatever you want;
+ *           There is no any warranty and it's posted in the hope that it will be useful.
+ *
+ * @brief Lock-free histogram of durations with log2 buckets ( in units of the clock they were measured by ).
+ *
+ * Bucket 0 counts zero durations, bucket i counts durations of [2^(i-1), 2^i). record() should be called only
+ * by one writer, summary() could be called by any thread at any time: counters are atomic, but the snapshot
+ * of them is not consistent, so a few durations recorded meanwhile could be missing in percentiles.
+ * Percentiles are upper bounds of buckets ( but never more than max ), so they overestimate by less than 2 times.
+ */
+
+#ifndef __LATENCY_HISTOGRAM__
+#define __LATENCY_HISTOGRAM__
+
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+template<class Duration>
+class LatencyHistogram
+{
+    static_assert( std::is_unsigned<Duration>::value && sizeof( Duration ) <= 8, "Duration has to be unsigned integer" );
+
+public:
+    static constexpr uint32_t BUCKETS = sizeof( Duration ) * 8 + 1;
+
+    struct Summary
+    {
+        uint32_t count;
+        Duration p50;
+        Duration p99;
+        Duration max;
+    };
+
+    void record( Duration duration )
+    {
+        std::atomic<uint32_t>& bucket = buckets[bucket_of( duration )];
+        bucket.store( bucket.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+        if ( duration > longest.load( std::memory_order_relaxed ))
+        {
+            longest.store( duration, std::memory_order_relaxed );
+        }
+    }
+
+    Summary summary() const
+    {
+        uint32_t counts[BUCKETS];
+        Summary result{ 0, 0, 0, longest.load( std::memory_order_relaxed ) };
+        for ( uint32_t i = 0; i < BUCKETS; i++ )
+        {
+            counts[i] = buckets[i].load( std::memory_order_relaxed );
+            result.count += counts[i];
+        }
+        result.p50 = percentile( counts, result.count, 50, result.max );
+        result.p99 = percentile( counts, result.count, 99, result.max );
+        return result;
+    }
+
+private:
+    std::atomic<uint32_t> buckets[BUCKETS]{};
+    std::atomic<Duration> longest{0};
+
+    static uint32_t bucket_of( Duration duration )
+    {
+        if ( duration == 0 )
+        {
+            return 0;
+        }
+        return uint32_t( 64 - __builtin_clzll( static_cast<unsigned long long>( duration )));
+    }
+
+    /** upper bound of the bucket where percent of durations is reached */
+    static Duration percentile( const uint32_t* counts, uint32_t total, uint32_t percent, Duration max )
+    {
+        // rank of the duration, rounded up
+        uint64_t rank = ( uint64_t( total ) * percent + 99 ) / 100;
+        uint64_t seen{0};
+        for ( uint32_t i = 0; i < BUCKETS && rank != 0; i++ )
+        {
+            seen += counts[i];
+            if ( seen >= rank )
+            {
+                Duration bound = i == 0 ? 0 : Duration( Duration( Duration( 1 ) << ( i - 1 )) * 2 - 1 );
+                return bound < max ? bound : max;
+            }
+        }
+        return 0;
+    }
+};
+
+#endif //__LATENCY_HISTOGRAM__
@@ -0,0 +1,240 @@
+/**
+ * @author m-chichikalov@outlook.com
+ *
+ * @license  This is free chunk of code, you can do with it whatever you want;
+ *           There is no any warranty and it's posted in the hope that it will be useful.
+ *
+ * @brief POSIX ( Linux host ) backend of StreamSeparator, to be included instead of FreeRTOS headers.
+ *
+ * PosixQueue - CQueue with FreeRTOS-like interface, Dequeue( item, timeout ) blocks the thread up to timeout ms
+ * ( WAIT_FOREVER to wait without limit, 0 to only poll ), so next() honours set_timeout().
+ *
+ * IsrThread - thread standing in for IRQ: it reads chunks from the source ( e.g. read() of serial port or socket )
+ * and pushes them into separator inside of IRQ context.
+ *
+ * SteadyClock - Clock of msg timestamps, nanoseconds of std::chrono::steady_clock.
+ *
+ * IRQ context and critical section are emulated by atomics: thread entering critical section ( flush() ) masks
+ * "interrupts" and waits until all running IRQ contexts are left, IRQ contexts are not entered while masked.
+ * Producers do not block each other, so several ports could be served by their own threads.
+ *
+ *  @example
+ *  #include "posix_backend.hpp"
+ *  #include "stream_separator.hpp"
+ *
+ *  StreamSeparator<PosixQueue, UBX_Msg> ubx_stream;
+ *  ubx_stream.buffer( ring, sizeof( ring )).set_timeout( 500 ).create();
+ *
+ *  IsrThread irq( ubx_stream, [fd]( uint8_t* buf, size_t len ) -> size_t
+ *  {
+ *      ssize_t n = read( fd, buf, len );
+ *      return n > 0 ? size_t( n ) : 0;   // 0 stops the thread
+ *  });
+ *
+ *  while ( uint32_t len = ubx_stream.next( msg, sizeof( msg ))) { ... }
+ */
+
+#ifndef __POSIX_BACKEND__
+#define __POSIX_BACKEND__
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+typedef bool BaseType_t;
+
+namespace posix_backend {
+
+    inline std::atomic<bool> irq_masked{ false };
+    inline std::atomic<uint32_t> irq_running{0};
+
+    inline void critical_section_enter()
+    {
+        bool expected{ false };
+        while ( !irq_masked.compare_exchange_weak( expected, true, std::memory_order_acquire ))
+        {
+            expected = false;
+            std::this_thread::yield();
+        }
+        while ( irq_running.load( std::memory_order_acquire ) != 0 )
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    inline void critical_section_leave()
+    {
+        irq_masked.store( false, std::memory_order_release );
+    }
+
+    /** calls f() as IRQ handler, it's postponed while critical section is entered */
+    template<class F>
+    inline void run_as_isr( F f )
+    {
+        for ( ;; )
+        {
+            irq_running.fetch_add( 1, std::memory_order_seq_cst );
+            if ( !irq_masked.load( std::memory_order_seq_cst ))
+            {
+                break;
+            }
+            irq_running.fetch_sub( 1, std::memory_order_release );
+            while ( irq_masked.load( std::memory_order_acquire ))
+            {
+                std::this_thread::yield();
+            }
+        }
+        f();
+        irq_running.fetch_sub( 1, std::memory_order_release );
+    }
+}
+
+#define CRITICAL_SECTION_ENTER(x) posix_backend::critical_section_enter()
+#define CRITICAL_SECTION_LEAVE(x) posix_backend::critical_section_leave()
+/** thread blocked on PosixQueue is woken up by the queue itself */
+#define portYIELD_FROM_ISR(x)
+
+class PosixQueue
+{
+public:
+    static constexpr uint32_t WAIT_FOREVER = 0xFFFFFFFFU;
+
+    PosixQueue( size_t length, size_t size_of_entry ):
+        storage( length * size_of_entry ), length{ length }, size_of_entry{ size_of_entry }
+    {};
+
+    bool Enqueue( void* item )
+    {
+        {
+            std::lock_guard<std::mutex> lock( mutex );
+            if ( count == length )
+            {
+                return false;
+            }
+            memcpy( &storage[(( head + count ) % length ) * size_of_entry], item, size_of_entry );
+            count++;
+        }
+        not_empty.notify_one();
+        return true;
+    };
+    bool Enqueue( void* item, uint32_t ) { return Enqueue( item ); };
+    bool EnqueueFromISR( void* item, BaseType_t* pxHigherPriorityTaskWoken )
+    {
+        bool queued = Enqueue( item );
+        if ( pxHigherPriorityTaskWoken )
+        {
+            *pxHigherPriorityTaskWoken = queued;
+        }
+        return queued;
+    };
+
+    bool Dequeue( void* item, uint32_t timeout )
+    {
+        std::unique_lock<std::mutex> lock( mutex );
+        auto has_item = [this]{ return count != 0; };
+        if ( timeout == WAIT_FOREVER )
+        {
+            not_empty.wait( lock, has_item );
+        }
+        else if ( timeout == 0 )
+        {
+            // wait_for( 0 ) is not free, it sleeps at least for the timer slack of thread
+            if ( !has_item())
+            {
+                return false;
+            }
+        }
+        else if ( !not_empty.wait_for( lock, std::chrono::milliseconds( timeout ), has_item ))
+        {
+            return false;
+        }
+        memcpy( item, &storage[head * size_of_entry], size_of_entry );
+        head = ( head + 1 ) % length;
+        count--;
+        return true;
+    };
+    bool Dequeue( void* item ) { return Dequeue( item, WAIT_FOREVER ); };
+
+    void Flush()
+    {
+        std::lock_guard<std::mutex> lock( mutex );
+        head = 0;
+        count = 0;
+    };
+
+private:
+    std::mutex mutex;
+    std::condition_variable not_empty;
+    std::vector<uint8_t> storage;
+    size_t length;
+    size_t size_of_entry;
+    size_t head{0};
+    size_t count{0};
+};
+
+/** Clock of msg timestamps ( StreamSeparator<PosixQueue, UBX_Msg, 16, SteadyClock> ), nanoseconds of steady_clock. */
+struct SteadyClock
+{
+    using time_point = uint64_t;
+    static time_point now()
+    {
+        return uint64_t( std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+};
+
+/**
+ * Source is called in the loop as size_t source( uint8_t* buf, size_t len ), returns the number of received bytes
+ * ( it could block ), 0 stops the thread. Only pushing into separator is done inside of IRQ context.
+ */
+class IsrThread
+{
+public:
+    static constexpr size_t CHUNK = 4096;
+
+    template<class Separator, class Source>
+    IsrThread( Separator& separator, Source source ):
+        thread{[this, &separator, source]() mutable
+        {
+            std::vector<uint8_t> chunk( CHUNK );
+            while ( !stopped.load( std::memory_order_relaxed ))
+            {
+                size_t len = source( chunk.data(), chunk.size());
+                if ( len == 0 )
+                {
+                    break;
+                }
+                posix_backend::run_as_isr( [&]{ separator.push( chunk.data(), len ); });
+            }
+        }}
+    {};
+    ~IsrThread()
+    {
+        stop();
+        join();
+    };
+
+    IsrThread( const IsrThread& ) = delete;
+    IsrThread& operator=( const IsrThread& ) = delete;
+
+    /** the thread is stopped after the current call of source */
+    void stop() { stopped.store( true, std::memory_order_relaxed ); };
+    void join()
+    {
+        if ( thread.joinable())
+        {
+            thread.join();
+        }
+    };
+
+private:
+    std::atomic<bool> stopped{ false };
+    std::thread thread;
+};
+
+#endif //__POSIX_BACKEND__
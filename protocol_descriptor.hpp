@@ -0,0 +1,137 @@
+/**
+ * @author m-chichikalov@outlook.com
+ *
+ * @license  This is free chunk of code, you can do with it whatever you want;
+ *           There is no any warranty and it's posted in the hope that it will be useful.
+ *
+ * @brief Declarative description of msg header, StreamConverter is generated from it at compile time.
+ *
+ * ProtocolDescriptor describes:
+ *  - sync word of 1..4 bytes and its mask ( only bits set in mask are compared );
+ *  - length field: offset of its first byte from the start of msg, width and position ( of its LSB ) in bits
+ *    inside of the field bytes, endianness of the field bytes;
+ *  - overhead, the number of bytes of msg not counted by the length field ( header, checksum );
+ *  - optional key field ( type of msg, e.g. UBX class/ID, RTCM3 msg number ) the same way as length field.
+ *
+ * DescribedMsg<DESCRIPTOR> provides LEN_OF_SYNC, BYTE_CONTAINED_LEN, SYNC_PATTERN, get_sync() and get_len()
+ * required by StreamSeparator, and BYTE_CONTAINED_KEY with get_key() if key field is described.
+ * Sync word is assembled into one word and compared at once, length is extracted by shifts without unaligned access.
+ * Extra members ( verify(), MAX_LEN ) could be added by derived struct.
+ *
+ *  @example
+ *  inline constexpr ProtocolDescriptor RTCM3_DESCRIPTOR{
+ *      { 0xd3, 0x00 }, { 0xff, 0xfc }, 2,   // sync word and mask: 0xd3, 6 reserved bits
+ *      1, 10, 0, Endian::BIG,              // 10 bits of length in bytes 1..2
+ *      6,                                  // header 3 + crc 3
+ *      3, 12, 4, Endian::BIG };            // 12 bits of msg number in bytes 3..4
+ *
+ *  struct RTCM_Msg: DescribedMsg<RTCM3_DESCRIPTOR> {};
+ */
+
+#ifndef __PROTOCOL_DESCRIPTOR__
+#define __PROTOCOL_DESCRIPTOR__
+
+#include <cstdint>
+
+#include "utils_ringbuffer.h"
+#include "sync_scanner.hpp"
+
+enum class Endian: uint8_t
+{
+    LITTLE = 0,
+    BIG,
+};
+
+struct ProtocolDescriptor
+{
+    uint8_t  sync[4];
+    uint8_t  sync_mask[4];
+    uint32_t len_of_sync;   /** 1..4 */
+    uint32_t len_offset;    /** the first byte of length field from the start of msg */
+    uint32_t len_width;     /** in bits, 1..32 */
+    uint32_t len_shift;     /** position of LSB of length inside of the field bytes */
+    Endian   len_endian;
+    uint32_t overhead;      /** length of msg = value of length field + overhead */
+    uint32_t key_offset{0}; /** the first byte of key field from the start of msg */
+    uint32_t key_width{0};  /** in bits, 0 if there is no key field */
+    uint32_t key_shift{0};
+    Endian   key_endian{ Endian::BIG };
+};
+
+template<const ProtocolDescriptor& D>
+struct DescribedMsg
+{
+    static_assert( D.len_of_sync >= 1 && D.len_of_sync <= 4, "sync word has to be 1..4 bytes" );
+    static_assert( D.len_width >= 1 && D.len_shift + D.len_width <= 32, "length field has to fit 4 bytes" );
+    static_assert( D.key_shift + D.key_width <= 32, "key field has to fit 4 bytes" );
+
+    DescribedMsg() = delete;
+    ~DescribedMsg() = delete;
+
+    static constexpr uint32_t LEN_OF_SYNC = D.len_of_sync;
+    static constexpr uint32_t LEN_FIELD_BYTES = ( D.len_shift + D.len_width + 7 ) / 8;
+    static constexpr uint32_t BYTE_CONTAINED_LEN = D.len_offset + LEN_FIELD_BYTES;
+    // length field could share bytes with sync word ( masked out bits ), but has to end after it
+    static_assert( BYTE_CONTAINED_LEN > LEN_OF_SYNC, "length field has to end after sync word" );
+    static constexpr uint32_t KEY_FIELD_BYTES = ( D.key_shift + D.key_width + 7 ) / 8;
+    /** 0 if there is no key field */
+    static constexpr uint32_t BYTE_CONTAINED_KEY = D.key_width != 0 ? D.key_offset + KEY_FIELD_BYTES : 0;
+    static_assert( BYTE_CONTAINED_KEY == 0 || BYTE_CONTAINED_KEY > LEN_OF_SYNC,
+                   "key field has to end after sync word" );
+    static constexpr SyncPattern SYNC_PATTERN{{ D.sync[0], D.sync[1] },
+                                              { D.sync_mask[0], D.len_of_sync > 1 ? D.sync_mask[1] : uint8_t( 0 ) }};
+
+    static bool get_sync( const struct ringbuffer& rb)
+    {
+        return ( word<LEN_OF_SYNC, Endian::BIG>( rb ) & SYNC_MASK ) == SYNC_WORD;
+    }
+
+    static uint32_t get_len( const struct ringbuffer& rb)
+    {
+        return (( word<LEN_FIELD_BYTES, D.len_endian>( rb ) >> D.len_shift ) & LEN_MASK ) + D.overhead;
+    }
+
+    /** called when BYTE_CONTAINED_KEY bytes of msg are received */
+    static uint32_t get_key( const struct ringbuffer& rb)
+    {
+        return ( word<KEY_FIELD_BYTES, D.key_endian>( rb ) >> D.key_shift ) & KEY_MASK;
+    }
+
+private:
+    /** the last n received bytes as one word */
+    template<uint32_t n, Endian endian>
+    static uint32_t word( const struct ringbuffer& rb)
+    {
+        uint32_t value{0};
+        for ( uint32_t i = 0; i < n; i++ )
+        {
+            uint32_t byte = rb.buf[( rb.write_index - n + i ) & rb.size];
+            if constexpr ( endian == Endian::BIG )
+            {
+                value = ( value << 8 ) | byte;
+            }
+            else
+            {
+                value |= byte << ( 8 * i );
+            }
+        }
+        return value;
+    }
+
+    static constexpr uint32_t pack( const uint8_t* bytes )
+    {
+        uint32_t value{0};
+        for ( uint32_t i = 0; i < D.len_of_sync; i++ )
+        {
+            value = ( value << 8 ) | bytes[i];
+        }
+        return value;
+    }
+
+    static constexpr uint32_t SYNC_MASK = pack( D.sync_mask );
+    static constexpr uint32_t SYNC_WORD = pack( D.sync ) & SYNC_MASK;
+    static constexpr uint32_t LEN_MASK = D.len_width == 32 ? 0xFFFFFFFFU : ( 1U << D.len_width ) - 1;
+    static constexpr uint32_t KEY_MASK = D.key_width == 32 ? 0xFFFFFFFFU : ( 1U << D.key_width ) - 1;
+};
+
+#endif //__PROTOCOL_DESCRIPTOR__
@@ -0,0 +1,90 @@
+/**
+ * @author m-chichikalov@outlook.com
+ *
+ * @license  This is free chunk of code, you can do with it whatever you want;
+ *           There is no any warranty and it's posted in the hope that it will be useful.
+ *
+ * @brief Wait-free queue for exactly one producer ( IRQ ) and one consumer ( thread ).
+ *
+ * push() should be called only by producer, pop() and front() only by consumer ( producer could pop too, if they
+ * never do it at the same time, e.g. under a lock ), reset() only when both are stopped
+ * ( e.g. inside critical section ). DEPTH has to be power of 2.
+ *
+ * Indices are placed on separate cache lines, so producer and consumer do not fight for the same line.
+ * The size of line could be set by STREAM_SEPARATOR_CACHE_LINE ( 64 by default, makes sense to reduce it
+ * on MCU without cache ).
+ */
+
+#ifndef __SPSC_QUEUE__
+#define __SPSC_QUEUE__
+
+#include <atomic>
+#include <cstdint>
+
+#ifndef STREAM_SEPARATOR_CACHE_LINE
+#define STREAM_SEPARATOR_CACHE_LINE 64
+#endif
+
+template<class T, uint32_t DEPTH>
+class SpscQueue
+{
+    static_assert( DEPTH != 0 && ( DEPTH & ( DEPTH - 1 )) == 0, "DEPTH of queue has to be power of 2" );
+
+public:
+    bool push( const T& item )
+    {
+        uint32_t head_ = head.load( std::memory_order_relaxed );
+        if ( head_ - tail.load( std::memory_order_acquire ) == DEPTH )
+        {
+            return false;
+        }
+        entries[head_ & ( DEPTH - 1 )] = item;
+        head.store( head_ + 1, std::memory_order_release );
+        return true;
+    }
+
+    bool pop( T& item )
+    {
+        uint32_t tail_ = tail.load( std::memory_order_relaxed );
+        if ( tail_ == head.load( std::memory_order_acquire ))
+        {
+            return false;
+        }
+        item = entries[tail_ & ( DEPTH - 1 )];
+        tail.store( tail_ + 1, std::memory_order_release );
+        return true;
+    }
+
+    /** the entry pop() would return, nullptr if queue is empty; it stays valid until it's popped */
+    const T* front() const
+    {
+        uint32_t tail_ = tail.load( std::memory_order_relaxed );
+        if ( tail_ == head.load( std::memory_order_acquire ))
+        {
+            return nullptr;
+        }
+        return &entries[tail_ & ( DEPTH - 1 )];
+    }
+
+    bool empty() const
+    {
+        return head.load( std::memory_order_acquire ) == tail.load( std::memory_order_acquire );
+    }
+
+    uint32_t size() const
+    {
+        return head.load( std::memory_order_acquire ) - tail.load( std::memory_order_acquire );
+    }
+
+    void reset()
+    {
+        tail.store( head.load( std::memory_order_relaxed ), std::memory_order_relaxed );
+    }
+
+private:
+    alignas( STREAM_SEPARATOR_CACHE_LINE ) std::atomic<uint32_t> head{0};
+    alignas( STREAM_SEPARATOR_CACHE_LINE ) std::atomic<uint32_t> tail{0};
+    alignas( STREAM_SEPARATOR_CACHE_LINE ) T entries[DEPTH];
+};
+
+#endif //__SPSC_QUEUE__
@@ -9,22 +9,93 @@
  * Designed to be used with:
  * 1 - FreeRTOS C++ addons <a href="https://github.com/michaelbecker/freertos-addons">C++ addons</a>
  * 2 - Ring buffer from Atmel ASF-4.0 <a href="https://microchipdeveloper.com/atstart:start">Atmel ASF-4.0</a>
+ * or on Linux host with posix_backend.hpp ( PosixQueue, IsrThread ) included instead of FreeRTOS headers.
+ * coroutine_backend.hpp ( C++20 ) adds co_await async_next( executor ) and async generator frames().
  *
  * push( byte ) should be used to push data into buffer, @warning designed to be called only from IRQ.
  *
+ * push( data, len ) the same for a chunk of bytes ( DMA half/full transfer callbacks ),
+ * the chunk copied into buffer at once and all msgs found in it are queued with a single yield.
+ *
  * next( buff, len_of_buff ) return length of message that was copied into provided by parameters buffer,
  * if message longer than provided buffer it's discarded.
  * return 0 if there is no messages in queue.
  *
+ * peek_frame( frame ) the zero-copy alternative of next(), frame points straight into ring-buffer
+ * ( one or two parts, if msg wraps around the end of it ); the msg occupies buffer until release_frame().
+ * next_frame() returns the same as move-only FrameView which releases msg when destroyed,
+ * try_next_frame() the same without waiting.
+ *
+ * next_batch( sink, max_frames ) blocks only for the first msg, then passes all msgs already in queue
+ * ( up to max_frames ) to sink( const StreamFrame& ) without blocking, so a burst of msgs costs a single wake-up.
+ *
  * flush() - clean the ring-buffer and reset queue.
  *
+ * stats() - snapshot of health counters ( missed and discarded bytes, delivered msgs, msgs dropped for short buffer,
+ * queue-full events, msgs lost by overflow policy, high-water mark of buffer ), consistent without critical section
+ * ( sequence counter ).
+ *
+ * set_overflow( policy ) - what happens when pushed bytes do not fit into buffer ( see Overflow ), by default
+ * they are just missed and the msg being received goes on without them.
+ *
  *  next() blocks the thread for period of time which could be set by set_timeout().
  *
+ *  StreamSeparator<CQueue, StreamConverter, QUEUE_DEPTH, Clock> timestamps msgs by Clock::now() ( e.g. CycleCounterClock
+ *  on Cortex-M, SteadyClock of posix_backend.hpp ), it's sampled in IRQ when sync word of msg is detected and when
+ *  the msg is completed. Both are carried in its descriptor and given by next( buff, size, times ),
+ *  peek_frame( frame, times ), sink( frame, times ) of next_batch() and FrameView::times().
+ *  Bytes pushed by push( data, len ) are processed together, so their msgs get the time of the chunk callback;
+ *  msg found among bytes of bogus one gets the time it was found. Without Clock ( NoClock ) nothing is sampled.
+ *
+ *  If STREAM_SEPARATOR_LATENCY_HISTOGRAM is defined, separators with Clock keep log2 histograms of latency of msgs
+ *  taken by thread: sync -> complete and complete -> taken ( Clock::now() is called by thread as well ),
+ *  latency() gives their count, p50, p99 and max in ticks of Clock. Nothing of it is compiled without the flag.
+ *
+ *  Meta-data of msgs is passed from IRQ to thread through built-in wait-free queue of QUEUE_DEPTH entries,
+ *  CQueue is used only to wake up the thread blocked in next(), so the queue of one entry is enough.
+ *
  *  It requires help functions provided as a class with static members
  *  BYTE_CONTAINED_LEN, LEN_OF_SYNC,
  *  uint32_t get_len( const struct ringbuffer& rb) and
  *  bool get_sync( const struct ringbuffer& rb)
  *
+ *  Msgs without length field are framed by terminator, such converter has
+ *  TERMINATOR ( e.g. "\r\n" for NMEA-0183 ), MAX_LEN and LEN_OF_SYNC with bool get_sync( const struct ringbuffer& rb)
+ *  instead of BYTE_CONTAINED_LEN and get_len(). Msg longer than MAX_LEN without terminator is bogus.
+ *
+ *  Msgs of constant size are described by FIXED_LEN and LEN_OF_SYNC with bool get_sync( const struct ringbuffer& rb)
+ *  instead of BYTE_CONTAINED_LEN and get_len(), msg is completed right after FIXED_LEN bytes from its sync.
+ *
+ *  Converter with length field could be generated from constexpr ProtocolDescriptor ( sync word, its mask,
+ *  offset, width, bit position and endianness of length field, overhead ) as DescribedMsg<DESCRIPTOR>,
+ *  see protocol_descriptor.hpp.
+ *
+ *  Optional MAX_LEN limits the length of msg, msg announcing longer one ( or longer than buffer ) is bogus.
+ *
+ *  Optional bool verify( const struct ringbuffer& rb, uint32_t index, uint32_t len ) checks the received msg
+ *  ( e.g. checksum ), index is the first byte of msg in ring-buffer ( not masked ). Msgs failed it are discarded
+ *  and never returned by next().
+ *
+ *  Optional PRIORITIES with uint32_t priority( const struct ringbuffer& rb, uint32_t index, uint32_t len ) puts
+ *  the received msg into one of PRIORITIES classes by its header, every class has its own descriptors queue
+ *  of QUEUE_DEPTH and class 0 is served first. Msgs of converters without it are of the lowest class.
+ *  Buffer is given back only up to the oldest msg still waiting in any queue.
+ *
+ *  Optional BYTE_CONTAINED_KEY with uint32_t get_key( const struct ringbuffer& rb ) lets set_filter() drop msgs
+ *  of unwanted keys as soon as the key is received, the rest of such msg is never stored nor queued.
+ *
+ *  Bytes of bogus msg are searched again for sync word starting from the byte after its false sync,
+ *  so the real msg embedded into it ( e.g. when bytes were lost in the middle of previous msg ) is not lost.
+ *  Noise filling the whole buffer is discarded ( but the bytes which could start sync word ), as well as bytes
+ *  of descriptors lost on full queue, so the buffer is never kept full by bytes nobody is going to read.
+ *
+ *  MultiStreamSeparator<CQueue, UBX_Msg, RTCM_Msg, ...> ( StreamSeparator<CQueue, AnyOf<...>> ) looks for sync words
+ *  of all listed converters in one pass over the stream, every msg is tagged by the index of its converter
+ *  in StreamFrame::protocol ( see protocol_id<UBX_Msg>() ).
+ *
+ *  Optional SYNC_PATTERN ( the first two bytes of sync word and their masks ) lets push( data, len )
+ *  skip noise by vectorized search of sync candidates instead of calling get_sync() after every byte.
+ *
  *  @example help-class to parse UBX msgs from uart.
  *  The UBX msg has the next struct: SYNC1:SYNC2:CLASS:ID:LENGHT_L:LENGHT_H:.PAYLOAD_OF_LENGHT..:CS_L:CS_H
  *
@@ -35,6 +106,7 @@
  *
  *      static constexpr uint32_t BYTE_CONTAINED_LEN = 6;
  *      static constexpr uint32_t LEN_OF_SYNC = 2;
+ *      static constexpr SyncPattern SYNC_PATTERN{{ 0xb5, 0x62 }, { 0xff, 0xff }};
  *
  *      static uint32_t get_len( const struct ringbuffer& rb)
  *      {
@@ -57,8 +129,9 @@
  *
  * @example Example of simple usual usage below:
  *
- *  // creation of object.
+ *  // creation of object; up to 16 msgs could wait in queue by default.
  *  StreamSeparator<cpp_freertos::Queue, UBX_Msg> ubx_stream;
+ *  StreamSeparator<cpp_freertos::Queue, UBX_Msg, 64> ubx_stream_with_deeper_queue;
  *
  *  // constructing
  *  ubx_stream
@@ -69,32 +142,318 @@
  *  // The IRQ handler should push received byte by calling
  *  ubx_stream.push( received_byte );
  *
+ *  // or the DMA transfer callback pushes the whole received chunk
+ *  ubx_stream.push( dma_buffer, dma_chunk_len );
+ *
  *  // inside thread the next msg could be read by calling next()
  *  // if there is no msgs, the thread will be blocked on the queue
  *  // for provided by set_timeout() time or first arrived msg,
  *  // whatever happens early.
  *  uint32_t len = ubx_stream.next( buffer, buff_size );
  *
- *  @TODO:
- *  - length of queue hard-coded
- *  - think about msg with fixed length? how we can process them?
+ *  // or without copying, msg is released when view goes out of scope
+ *  if ( auto view = ubx_stream.next_frame())
+ *  {
+ *      decode( view->first.data, view->first.size, view->second.data, view->second.size );
+ *  }
  */
 
 
 #ifndef __STREAM_SEPARATOR__
 #define __STREAM_SEPARATOR__
 
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
 #include "utils_ringbuffer.h"
+#include "spsc_queue.hpp"
+#include "sync_scanner.hpp"
+#ifdef STREAM_SEPARATOR_LATENCY_HISTOGRAM
+#include "latency_histogram.hpp"
+#endif
+
+/** Msg located in the ring-buffer, the second part is empty unless msg wraps around the end of buffer. */
+struct StreamFrame
+{
+    struct Span
+    {
+        const uint8_t* data;
+        uint32_t size;
+    };
+
+    Span first;
+    Span second;
+    uint8_t protocol;  /** see StreamSeparator::protocol_id<StreamConverter>() */
+
+    uint32_t length() const
+    {
+        return first.size + second.size;
+    }
+
+    uint8_t operator[]( uint32_t i ) const
+    {
+        return i < first.size ? first.data[i] : second.data[i - first.size];
+    }
+};
+
+/** Meta-data of msg ( or bytes to be discarded ) in the ring-buffer, passed from IRQ to thread. */
+struct FrameDescriptor
+{
+    uint32_t start;    /** index of the first byte in ring-buffer ( not masked ) */
+    int32_t length;    /** if negative value - this number of bytes should be discarded */
+    uint8_t protocol;  /** index of StreamConverter recognised the msg */
+};
+
+/** Health counters of StreamSeparator, all of them are counted from create(). */
+struct StreamStats
+{
+    uint32_t missed_chars;      /** bytes did not fit into buffer */
+    uint32_t discarded_chars;   /** noise, bogus msgs and msgs failed verify() */
+    uint32_t delivered_frames;  /** msgs returned by next(), peek_frame(), next_batch() */
+    uint32_t dropped_oversize;  /** msgs longer than buffer provided to next() */
+    uint32_t queue_full;        /** descriptors lost because descriptors queue was full */
+    uint32_t ring_high_water;   /** max number of bytes occupied in buffer */
+    uint32_t dropped_overflow;  /** msgs invalidated, dropped or rejected by Overflow policy */
+    uint32_t filtered_frames;   /** msgs dropped by filter of keys */
+};
+
+/** What happens when pushed bytes do not fit into buffer ( the thread does not keep up with the stream ). */
+enum class Overflow
+{
+    /** bytes are missed, the msg being received goes on without them ( and is very likely spliced ) */
+    MISS_BYTES,
+    /** bytes are missed, the msg being received is discarded, sync is looked for in the next bytes */
+    INVALIDATE_MSG,
+    /**
+     * complete msgs which are not taken by thread yet are dropped, the oldest first, to make room;
+     * INVALIDATE_MSG if there is nothing to drop ( or thread is reading the oldest msg right now )
+     */
+    DROP_OLDEST,
+    /**
+     * msg is rejected as soon as its length is known, if the rest of it does not fit into free space
+     * ( its bytes are looked through for sync as bytes of any bogus msg ); INVALIDATE_MSG for msgs without length
+     */
+    REJECT_AT_SYNC,
+};
+
+/** How msgs of listed keys are filtered, see StreamSeparator::set_filter(). */
+enum class Filter
+{
+    ALLOW,  /** only msgs with listed keys are queued */
+    DENY,   /** msgs with listed keys are dropped */
+};
+
+/**
+ * Clock of frame timestamps, the default one: msgs are not timestamped and descriptors do not carry time.
+ * Any clock has time_point type and static time_point now(), which is called from IRQ.
+ */
+struct NoClock
+{
+    using time_point = uint32_t;
+    static time_point now() { return 0; }
+};
+
+#if defined( __ARM_ARCH_7M__ ) || defined( __ARM_ARCH_7EM__ ) || defined( __ARM_ARCH_8M_MAIN__ )
+/** Cycle counter of Cortex-M3/M4/M7/M33 ( DWT->CYCCNT ), it has to be enabled by application. */
+struct CycleCounterClock
+{
+    using time_point = uint32_t;
+    static time_point now() { return *reinterpret_cast<volatile uint32_t*>( 0xE0001004U ); }
+};
+#endif
+
+/** When sync word of msg was detected and when the msg was completed, by Clock of StreamSeparator. */
+template<class TimePoint>
+struct FrameTimes
+{
+    TimePoint sync;
+    TimePoint complete;
+};
+
+namespace stream_separator_detail {
+    /** optional members of StreamConverter */
+    template<class T, class = void>
+    struct has_sync_pattern: std::false_type {};
+    template<class T>
+    struct has_sync_pattern<T, std::void_t<decltype( T::SYNC_PATTERN )>>: std::true_type {};
+
+    template<class T, class = void>
+    struct has_terminator: std::false_type {};
+    template<class T>
+    struct has_terminator<T, std::void_t<decltype( T::TERMINATOR )>>: std::true_type {};
+
+    template<class T, class = void>
+    struct has_fixed_len: std::false_type {};
+    template<class T>
+    struct has_fixed_len<T, std::void_t<decltype( T::FIXED_LEN )>>: std::true_type {};
+
+    template<class T, class = void>
+    struct has_max_len: std::false_type {};
+    template<class T>
+    struct has_max_len<T, std::void_t<decltype( T::MAX_LEN )>>: std::true_type {};
+
+    template<class T, class = void>
+    struct has_verify: std::false_type {};
+    template<class T>
+    struct has_verify<T, std::void_t<decltype( T::verify( std::declval<const struct ringbuffer&>(), 0U, 0U ))>>: std::true_type {};
+
+    template<class T, class = void>
+    struct has_key: std::false_type {};
+    template<class T>
+    struct has_key<T, std::void_t<decltype( T::BYTE_CONTAINED_KEY )>>: std::true_type {};
+
+    /** the number of bytes of msg to get its key, 0 if converter has no key */
+    template<class T>
+    constexpr uint32_t key_position_of()
+    {
+        if constexpr ( has_key<T>::value )
+        {
+            return T::BYTE_CONTAINED_KEY;
+        }
+        return 0;
+    }
+
+    template<class T, class = void>
+    struct has_priority: std::false_type {};
+    template<class T>
+    struct has_priority<T, std::void_t<decltype( T::priority( std::declval<const struct ringbuffer&>(), 0U, 0U ))>>: std::true_type {};
+
+    template<class T>
+    constexpr uint32_t priorities_of()
+    {
+        if constexpr ( has_priority<T>::value )
+        {
+            static_assert( T::PRIORITIES != 0, "PRIORITIES of converter has to be at least 1" );
+            return T::PRIORITIES;
+        }
+        return 1;
+    }
+}
+
+/** Several StreamConverters recognised in one stream, used as StreamConverter of StreamSeparator. */
+template<class... StreamConverters>
+struct AnyOf
+{
+    AnyOf() = delete;
+    ~AnyOf() = delete;
+};
+
+namespace stream_separator_detail {
+    template<class T>
+    struct Tag
+    {
+        using type = T;
+    };
+
+    /**
+     * Access to the converter by its index in the list, when sync words of several ones match
+     * at the same byte, the first one in the list wins.
+     */
+    template<class... StreamConverters>
+    struct Protocols
+    {
+        static constexpr uint32_t COUNT = sizeof...( StreamConverters );
+        static constexpr uint32_t MAX_LEN_OF_SYNC = std::max({ StreamConverters::LEN_OF_SYNC... });
+        static constexpr uint32_t MIN_LEN_OF_SYNC = std::min({ StreamConverters::LEN_OF_SYNC... });
+        static constexpr bool HAS_SYNC_PATTERN = ( has_sync_pattern<StreamConverters>::value && ... );
+        static constexpr uint32_t PRIORITIES = std::max({ priorities_of<StreamConverters>()... });
+
+        template<class StreamConverter>
+        static constexpr uint8_t index_of()
+        {
+            uint8_t index{0};
+            bool found = (( std::is_same<StreamConverter, StreamConverters>::value ? true : ( index++, false )) || ... );
+            return found ? index : uint8_t( COUNT );
+        }
+
+        /** calls f( Tag<StreamConverter>{} ) for the converter with given index and returns its result */
+        template<class R, class F>
+        static R visit( uint8_t index, F&& f )
+        {
+            return visit<R>( index, f, std::index_sequence_for<StreamConverters...>{});
+        }
+
+        /** @return index of converter whose sync word has just been received or -1 */
+        static int32_t match_sync( const struct ringbuffer& cursor, uint32_t count_received_chars )
+        {
+            int32_t index{0};
+            bool found = (((( count_received_chars >= StreamConverters::LEN_OF_SYNC && StreamConverters::get_sync( cursor ))
+                            ? true : ( index++, false ))) || ... );
+            return found ? index : -1;
+        }
+
+        static size_t find_any_sync( const uint8_t* data, size_t len )
+        {
+            size_t found = len;
+            (( found = find_sync( data, found, StreamConverters::SYNC_PATTERN )), ... );
+            return found;
+        }
+
+    private:
+        template<class R, class F, size_t... I>
+        static R visit( uint8_t index, F& f, std::index_sequence<I...> )
+        {
+            if constexpr ( COUNT == 1 )
+            {
+                return f( Tag<std::tuple_element_t<0, std::tuple<StreamConverters...>>>{});
+            }
+            else
+            {
+                R result{};
+                (void)(( index == I ? ( result = f( Tag<StreamConverters>{} ), true ) : false ) || ... );
+                return result;
+            }
+        }
+    };
+
+    template<class StreamConverter>
+    struct protocols_of
+    {
+        using type = Protocols<StreamConverter>;
+    };
+    template<class... StreamConverters>
+    struct protocols_of<AnyOf<StreamConverters...>>
+    {
+        using type = Protocols<StreamConverters...>;
+    };
+
+    /** latency is not measured without Clock */
+    struct NoHistogram {};
 
-template<class CQueue, class StreamConverter>
+    /** descriptor of msg with its timestamps */
+    template<class TimePoint>
+    struct TimedDescriptor: FrameDescriptor
+    {
+        FrameTimes<TimePoint> times;
+    };
+}
+
+template<class CQueue, class StreamConverter, uint32_t QUEUE_DEPTH = 16, class Clock = NoClock>
 class StreamSeparator
 {
+    using Protocols = typename stream_separator_detail::protocols_of<StreamConverter>::type;
+    static constexpr bool TIMED = !std::is_same<Clock, NoClock>::value;
+
 public:
-    /** @todo > the length of queue hardcoded, maybe setup */
+    using time_point = typename Clock::time_point;
+    using Times = FrameTimes<time_point>;
+
+    /** index of converter in AnyOf<...> list, it's tagged to every msg; always 0 for a single converter */
+    template<class Converter>
+    static constexpr uint8_t protocol_id()
+    {
+        static_assert( Protocols::template index_of<Converter>() < Protocols::COUNT, "Converter is not in the list" );
+        return Protocols::template index_of<Converter>();
+    }
+
     StreamSeparator():
-        /** queue contains length of msg required to be read or discarded from buffer.
-         *  if negative value - this number of bytes should be discarded. */
-        queue{ 10, sizeof( int32_t )}
+        /** queue is used as binary semaphore, it gets token when msg arrives into empty descriptors queue */
+        queue{ 1, sizeof( int32_t )}
     {};
     ~StreamSeparator() {};
 
@@ -111,6 +470,27 @@ public:
         timeout = timeout_;
         return *this;
     }
+    StreamSeparator& set_overflow( Overflow overflow_ )
+    {
+        overflow = overflow_;
+        return *this;
+    }
+
+    /**
+     * Msgs of Converter are dropped in IRQ as soon as their key ( see BYTE_CONTAINED_KEY and get_key() ) and length
+     * are known, unless the key is in allowed keys ( or if it's in denied ones ). Keys have to be sorted, they are
+     * not copied; keys == nullptr removes the filter. Has to be set before pushing starts.
+     */
+    template<class Converter = StreamConverter>
+    StreamSeparator& set_filter( Filter mode, const uint32_t* keys, uint32_t count )
+    {
+        static_assert( stream_separator_detail::key_position_of<Converter>() != 0, "Converter has no key" );
+        static_assert( !stream_separator_detail::has_terminator<Converter>::value,
+                       "msgs framed by terminator could not be filtered" );
+        ASSERT( !keys || std::is_sorted( keys, keys + count ));
+        filters[protocol_id<Converter>()] = { keys, count, mode };
+        return *this;
+    }
 
     /** create() calls the last in the chain and do sanity work */
     void create()
@@ -120,36 +500,227 @@ public:
 
     int32_t next ( uint8_t* buff_read_to, uint32_t size )
     {
-        int32_t retval{0};
-        while ( queue.Dequeue( &retval, timeout ))
+        ASSERT( !peeked );
+        StreamFrame frame;
+        while ( take_frame( frame, true ))
         {
-            if ( retval > int32_t( size ) || retval < 0 )
+            uint32_t len = frame.length();
+            if ( len > size )
             {
                 /**
                  * There is a strategy to discard received msg
                  * when it's length more than receiver can accept.
                  */
-                discard( std::abs( retval ));
-                retval = 0;
+                count( dropped_oversize, 1 );
+                release_taken();
                 continue;
             }
+            memcpy( buff_read_to, frame.first.data, frame.first.size );
+            memcpy( buff_read_to + frame.first.size, frame.second.data, frame.second.size );
+            release_taken();
+            count( delivered_frames, 1 );
+            return int32_t( len );
+        }
+        return 0;
+    }
+
+    /** next() which gives timestamps of the msg as well, StreamSeparator has to be given a Clock */
+    int32_t next( uint8_t* buff_read_to, uint32_t size, Times& times )
+    {
+        static_assert( TIMED, "msgs are not timestamped by NoClock" );
+        int32_t len = next( buff_read_to, size );
+        if ( len != 0 )
+        {
+            times = taken_times;
+        }
+        return len;
+    }
+
+    /**
+     * Zero-copy version of next(), blocks the same way.
+     * @return false if there is no msgs in queue.
+     * The msg stays in the buffer until release_frame() is called, only one msg could be peeked at time.
+     */
+    bool peek_frame( StreamFrame& frame )
+    {
+        return peek( frame, true );
+    }
+
+    bool peek_frame( StreamFrame& frame, Times& times )
+    {
+        static_assert( TIMED, "msgs are not timestamped by NoClock" );
+        if ( !peek_frame( frame ))
+        {
+            return false;
+        }
+        times = taken_times;
+        return true;
+    }
+
+    /**
+     * Blocks only for the first msg the same way as next(), then passes to sink( const StreamFrame& ) every msg
+     * which is already in queue without blocking, up to max_frames. Msg is released right after sink returns.
+     * sink( const StreamFrame&, const Times& ) gets timestamps of msgs as well.
+     * @return the number of msgs passed to sink.
+     */
+    template<class FrameSink>
+    uint32_t next_batch( FrameSink& sink, uint32_t max_frames )
+    {
+        ASSERT( !peeked );
+        uint32_t taken{0};
+        StreamFrame frame;
+        while ( taken < max_frames && take_frame( frame, taken == 0 ))
+        {
+            if constexpr ( std::is_invocable<FrameSink&, const StreamFrame&, const Times&>::value )
+            {
+                sink( static_cast<const StreamFrame&>( frame ), static_cast<const Times&>( taken_times ));
+            }
             else
             {
-                int32_t was_read{0};
-                while ( was_read < retval) {
-                    ringbuffer_get( &rb, &buff_read_to[was_read++]);
+                sink( static_cast<const StreamFrame&>( frame ));
+            }
+            release_taken();
+            taken++;
+        }
+        count( delivered_frames, taken );
+        return taken;
+    }
+
+    void release_frame()
+    {
+        if ( peeked )
+        {
+            release_taken();
+        }
+        peeked = false;
+    }
+
+    /** Owns the peeked msg and releases it when destroyed. */
+    class FrameView
+    {
+    public:
+        FrameView( const FrameView& ) = delete;
+        FrameView& operator=( const FrameView& ) = delete;
+
+        /** empty view, it owns nothing */
+        FrameView() = default;
+        FrameView( FrameView&& other ): owner{ other.owner }, frame{ other.frame }, frame_times{ other.frame_times }
+        {
+            other.owner = nullptr;
+        }
+        FrameView& operator=( FrameView&& other )
+        {
+            if ( this != &other )
+            {
+                if ( owner )
+                {
+                    owner->release_frame();
                 }
-                break;
+                owner = other.owner;
+                frame = other.frame;
+                frame_times = other.frame_times;
+                other.owner = nullptr;
+            }
+            return *this;
+        }
+        ~FrameView()
+        {
+            if ( owner )
+            {
+                owner->release_frame();
             }
         }
-        return retval;
+
+        explicit operator bool() const { return owner != nullptr; }
+        const StreamFrame& operator*() const { return frame; }
+        const StreamFrame* operator->() const { return &frame; }
+        /** timestamps of msg, zeros if StreamSeparator has no Clock */
+        const Times& times() const { return frame_times; }
+
+    private:
+        friend class StreamSeparator;
+
+        StreamSeparator* owner{ nullptr };
+        StreamFrame frame{};
+        Times frame_times{};
+    };
+
+    FrameView next_frame()
+    {
+        return take_view( true );
+    }
+
+    /** the same as next_frame(), but never waits: the view is empty if there is no msgs in queue right now */
+    FrameView try_next_frame()
+    {
+        return take_view( false );
+    }
+
+    /**
+     * Consistent snapshot of counters, could be called from any thread without entering critical section:
+     * counters of IRQ are re-read if IRQ updated them meanwhile.
+     */
+    StreamStats stats() const
+    {
+        StreamStats snapshot{};
+        uint32_t before;
+        uint32_t after;
+        do {
+            before = irq_stats.sequence.load( std::memory_order_acquire );
+            snapshot.missed_chars = irq_stats.missed_chars.load( std::memory_order_relaxed );
+            snapshot.discarded_chars = irq_stats.discarded_chars.load( std::memory_order_relaxed );
+            snapshot.queue_full = irq_stats.queue_full.load( std::memory_order_relaxed );
+            snapshot.ring_high_water = irq_stats.ring_high_water.load( std::memory_order_relaxed );
+            snapshot.dropped_overflow = irq_stats.dropped_overflow.load( std::memory_order_relaxed );
+            snapshot.filtered_frames = irq_stats.filtered_frames.load( std::memory_order_relaxed );
+            std::atomic_thread_fence( std::memory_order_acquire );
+            after = irq_stats.sequence.load( std::memory_order_relaxed );
+        } while (( before & 1U ) != 0 || before != after );
+
+        snapshot.delivered_frames = delivered_frames.load( std::memory_order_relaxed );
+        snapshot.dropped_oversize = dropped_oversize.load( std::memory_order_relaxed );
+        return snapshot;
+    }
+
+#ifdef STREAM_SEPARATOR_LATENCY_HISTOGRAM
+    struct Latency
+    {
+        typename LatencyHistogram<time_point>::Summary receiving;  /** sync -> complete */
+        typename LatencyHistogram<time_point>::Summary waiting;    /** complete -> taken by thread */
+    };
+
+    /** latency of msgs taken by thread ( including dropped for short buffer ), could be called from any thread */
+    Latency latency() const
+    {
+        static_assert( TIMED, "msgs are not timestamped by NoClock" );
+        return { receiving.summary(), waiting.summary() };
+    }
+#endif
+
+    /**
+     * co_await async_next( executor ) resumes the coroutine on executor when msg arrives, returns FrameView.
+     * CQueue has to be awaitable ( AsyncQueue of coroutine_backend.hpp ).
+     */
+    template<class Executor>
+    auto async_next( Executor& executor )
+    {
+        return queue.async_wait( *this, executor );
     }
 
     void flush()
     {
         CRITICAL_SECTION_ENTER();
             queue.Flush();
+            for ( auto& descriptors_of_class: descriptors )
+            {
+                descriptors_of_class.reset();
+            }
             ringbuffer_flush( &rb );
+            retired_end = rb.write_index;
+            peeked = false;
+            taking.store( UNLOCKED, std::memory_order_relaxed );
+            lost_descriptors = false;
+            skip_bytes = 0;
             alg_state.count_received_chars = 0;
             alg_state.state = State::LOOKING_FOR_SYNC;
         CRITICAL_SECTION_LEAVE();
@@ -157,79 +728,958 @@ public:
 
     void push ( uint8_t byte )
     {
-        // Checking available space before pushing into
-        if ( ringbuffer_num( &rb ) <= rb.size )
+        BaseType_t pxHigherPriorityTaskWoken = false;
+        uint32_t sequence = begin_irq_stats();
+        requeue_lost();
+
+        if ( skip_bytes != 0 )
         {
-            ringbuffer_put( &rb, byte );
-            detect();
+            // the rest of msg dropped by filter is not stored
+            skip_bytes--;
         }
         else
         {
-            alg_state.count_missed_chars++;
+            // Checking available space before pushing into
+            if ( free_space() == 0 )
+            {
+                make_room( 1 );
+            }
+            if ( free_space() != 0 )
+            {
+                // not ringbuffer_put(), it touches read_index owned by thread
+                rb.buf[rb.write_index & rb.size] = byte;
+                rb.write_index++;
+                process( rb.write_index - 1 );
+            }
+            else
+            {
+                count( irq_stats.missed_chars, 1 );
+                invalidate();
+            }
+        }
+        update_high_water();
+        irq_stats.sequence.store( sequence + 2, std::memory_order_release );
+        wake_thread( pxHigherPriorityTaskWoken );
+
+        if( pxHigherPriorityTaskWoken )
+        {
+            portYIELD_FROM_ISR( pxHigherPriorityTaskWoken );
+        }
+    }
+
+    void push ( const uint8_t* data, size_t len )
+    {
+        BaseType_t pxHigherPriorityTaskWoken = false;
+        uint32_t sequence = begin_irq_stats();
+        requeue_lost();
+
+        // the rest of msg dropped by filter is not stored
+        size_t skip = len < skip_bytes ? len : skip_bytes;
+        skip_bytes -= uint32_t( skip );
+        data += skip;
+        len -= skip;
+
+        // Only what fits into the buffer is taken, the rest of chunk is missed.
+        if ( free_space() < len )
+        {
+            make_room( len );
+        }
+        uint32_t space = free_space();
+        uint32_t to_copy = len < space ? uint32_t( len ) : space;
+        count( irq_stats.missed_chars, uint32_t( len - to_copy ));
+
+        // At most two segments: up to the end of buffer and from the beginning of it.
+        uint32_t offset = rb.write_index & rb.size;
+        uint32_t first = rb.size + 1 - offset;
+        if ( first > to_copy )
+        {
+            first = to_copy;
+        }
+        memcpy( &rb.buf[offset], data, first );
+        memcpy( rb.buf, data + first, to_copy - first );
+
+        uint32_t begin = rb.write_index;
+        rb.write_index += to_copy;
+        process( begin );
+        if ( to_copy != len )
+        {
+            // missed bytes could be the rest of msg dropped by filter
+            uint32_t missed = uint32_t( len - to_copy );
+            skip_bytes -= missed < skip_bytes ? missed : skip_bytes;
+            invalidate();
+        }
+        update_high_water();
+        irq_stats.sequence.store( sequence + 2, std::memory_order_release );
+        wake_thread( pxHigherPriorityTaskWoken );
+
+        if( pxHigherPriorityTaskWoken )
+        {
+            portYIELD_FROM_ISR( pxHigherPriorityTaskWoken );
         }
     }
 
 private:
+    using Descriptor = typename std::conditional<TIMED, stream_separator_detail::TimedDescriptor<time_point>,
+                                                 FrameDescriptor>::type;
+
     CQueue queue;
+    /** queue per priority class, the first one is served first ( it takes discarded bytes as well ) */
+    SpscQueue<Descriptor, QUEUE_DEPTH> descriptors[Protocols::PRIORITIES];
     struct ringbuffer rb{};
     uint32_t timeout{0};
+    Overflow overflow{ Overflow::MISS_BYTES };
+    bool peeked{ false };
+    uint32_t peeked_end{0};
+    /** descriptors were queued by IRQ since the thread was woken up last time */
+    bool queued{ false };
+    /** timestamps of the msg taken by take_frame() */
+    Times taken_times{};
+    /** msgs are taken out of order ( several priority classes ), bytes up to it are done with by thread */
+    uint32_t retired_end{0};
+    /**
+     * descriptors were lost ( queue full ) or msg was dropped by filter and no one was queued after them,
+     * their bytes end at lost_end
+     */
+    bool lost_descriptors{ false };
+    uint32_t lost_end{0};
+
+    struct KeyFilter
+    {
+        const uint32_t* keys;
+        uint32_t count;
+        Filter mode;
+    };
+    KeyFilter filters[Protocols::COUNT]{};
+    /** the rest of msg dropped by filter, it's not stored into buffer */
+    uint32_t skip_bytes{0};
 
     enum class State
     {
         LOOKING_FOR_SYNC = 0,
         WAITING_LENGTH,
         WAITING_FULL_MSG,
+        WAITING_TERMINATOR,
     };
 
     struct {
         State state;
         uint32_t count_received_chars;
-        uint32_t count_missed_chars;
         uint32_t full_msg_length;
-    } alg_state{ State::LOOKING_FOR_SYNC, 0, 0, 0 };
+        uint8_t protocol;
+        time_point sync_time;
+        uint32_t key_position;  /** 0 if msg is not filtered */
+        uint32_t key;
+    } alg_state{ State::LOOKING_FOR_SYNC, 0, 0, 0, {}, 0, 0 };
 
-    void discard ( uint32_t len_ )
+    /** written only by IRQ, sequence is odd while they are being updated */
+    struct {
+        std::atomic<uint32_t> sequence{0};
+        std::atomic<uint32_t> missed_chars{0};
+        std::atomic<uint32_t> discarded_chars{0};
+        std::atomic<uint32_t> queue_full{0};
+        std::atomic<uint32_t> ring_high_water{0};
+        std::atomic<uint32_t> dropped_overflow{0};
+        std::atomic<uint32_t> filtered_frames{0};
+    } irq_stats;
+
+    /**
+     * Overflow::DROP_OLDEST: descriptors are popped ( and their bytes reclaimed ) by thread or by IRQ,
+     * whoever holds the lock. Thread holds it while it reads the msg, IRQ only tries it and never waits.
+     */
+    enum : uint32_t { UNLOCKED, THREAD, IRQ };
+    std::atomic<uint32_t> taking{ UNLOCKED };
+
+    /** written only by thread */
+    std::atomic<uint32_t> delivered_frames{0};
+    std::atomic<uint32_t> dropped_oversize{0};
+#ifdef STREAM_SEPARATOR_LATENCY_HISTOGRAM
+    using Histogram = typename std::conditional<TIMED, LatencyHistogram<time_point>,
+                                                stream_separator_detail::NoHistogram>::type;
+    Histogram receiving;
+    Histogram waiting;
+#endif
+
+    /** the only writer of counter, so no read-modify-write is needed */
+    static void count( std::atomic<uint32_t>& counter, uint32_t n )
     {
-        CRITICAL_SECTION_ENTER();
-            rb.read_index += len_;
-        CRITICAL_SECTION_LEAVE();
+        counter.store( counter.load( std::memory_order_relaxed ) + n, std::memory_order_relaxed );
     }
 
-    void detect()
+    uint32_t begin_irq_stats()
     {
-        BaseType_t pxHigherPriorityTaskWoken = false;
+        uint32_t sequence = irq_stats.sequence.load( std::memory_order_relaxed );
+        irq_stats.sequence.store( sequence + 1, std::memory_order_relaxed );
+        std::atomic_thread_fence( std::memory_order_release );
+        return sequence;
+    }
+
+    void update_high_water()
+    {
+        uint32_t used = rb.size + 1 - free_space();
+        if ( used > irq_stats.ring_high_water.load( std::memory_order_relaxed ))
+        {
+            irq_stats.ring_high_water.store( used, std::memory_order_relaxed );
+        }
+    }
+
+    /**
+     * read_index is moved only by thread and write_index only by IRQ, so each side reads the index
+     * of the other one atomically instead of entering critical section.
+     */
+    uint32_t free_space() const
+    {
+        return rb.size + 1 - ( rb.write_index - __atomic_load_n( &rb.read_index, __ATOMIC_ACQUIRE ));
+    }
+
+    /** gives buffer space up to the end index back to IRQ */
+    void reclaim( uint32_t end )
+    {
+        if ( int32_t( end - rb.read_index ) > 0 )
+        {
+            __atomic_store_n( &rb.read_index, end, __ATOMIC_RELEASE );
+        }
+    }
+
+    void lock_for_thread()
+    {
+        if ( overflow == Overflow::DROP_OLDEST )
+        {
+            uint32_t expected{ UNLOCKED };
+            // IRQ could hold it only while it's running, it does not wait for anything
+            while ( !taking.compare_exchange_weak( expected, THREAD, std::memory_order_acquire ))
+            {
+                expected = UNLOCKED;
+            }
+        }
+    }
+
+    void unlock_for_thread()
+    {
+        if ( overflow == Overflow::DROP_OLDEST )
+        {
+            taking.store( UNLOCKED, std::memory_order_release );
+        }
+    }
+
+    /**
+     * Bytes up to end are done with. Msgs of several priority classes are taken out of order, so buffer
+     * is given back only up to the oldest msg ( or discarded bytes ) still waiting in any queue.
+     */
+    void retire( uint32_t end )
+    {
+        if constexpr ( Protocols::PRIORITIES == 1 )
+        {
+            reclaim( end );
+        }
+        else
+        {
+            if ( int32_t( end - retired_end ) > 0 )
+            {
+                retired_end = end;
+            }
+            uint32_t until = retired_end;
+            for ( const auto& descriptors_of_class: descriptors )
+            {
+                const Descriptor* waiting = descriptors_of_class.front();
+                if ( waiting && int32_t( until - waiting->start ) > 0 )
+                {
+                    until = waiting->start;
+                }
+            }
+            reclaim( until );
+        }
+    }
+
+    /** the msg taken by take_frame() is done with */
+    void release_taken()
+    {
+        retire( peeked_end );
+        unlock_for_thread();
+    }
+
+    bool no_descriptors() const
+    {
+        for ( const auto& descriptors_of_class: descriptors )
+        {
+            if ( !descriptors_of_class.empty())
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /** the descriptor queued the earliest among all classes */
+    bool pop_oldest( Descriptor& descriptor )
+    {
+        SpscQueue<Descriptor, QUEUE_DEPTH>* oldest{ nullptr };
+        for ( auto& descriptors_of_class: descriptors )
+        {
+            const Descriptor* waiting = descriptors_of_class.front();
+            if ( waiting && ( !oldest || int32_t( waiting->start - oldest->front()->start ) < 0 ))
+            {
+                oldest = &descriptors_of_class;
+            }
+        }
+        return oldest && oldest->pop( descriptor );
+    }
+
+    /** Overflow::DROP_OLDEST: msgs not taken by thread yet are dropped, the oldest first, until needed bytes fit */
+    void make_room( size_t needed )
+    {
+        uint32_t expected{ UNLOCKED };
+        if ( overflow != Overflow::DROP_OLDEST ||
+             !taking.compare_exchange_strong( expected, IRQ, std::memory_order_acquire ))
+        {
+            return;
+        }
+        Descriptor descriptor;
+        while ( free_space() < needed && pop_oldest( descriptor ))
+        {
+            if ( descriptor.length < 0 )
+            {
+                retire( descriptor.start - descriptor.length );
+                continue;
+            }
+            retire( descriptor.start + uint32_t( descriptor.length ));
+            count( irq_stats.dropped_overflow, 1 );
+        }
+        if ( lost_descriptors && no_descriptors())
+        {
+            retire( lost_end );
+            lost_descriptors = false;
+        }
+        taking.store( UNLOCKED, std::memory_order_release );
+    }
+
+    /**
+     * Bytes were missed: the msg being received ( or sync word ) would be spliced, so bytes received
+     * since the last msg are discarded, unless the policy is Overflow::MISS_BYTES.
+     */
+    void invalidate()
+    {
+        if ( overflow == Overflow::MISS_BYTES || alg_state.count_received_chars == 0 )
+        {
+            return;
+        }
+        if ( alg_state.state != State::LOOKING_FOR_SYNC )
+        {
+            count( irq_stats.dropped_overflow, 1 );
+        }
+        enqueue({ rb.write_index - alg_state.count_received_chars, -int32_t( alg_state.count_received_chars ), 0 });
+        alg_state.count_received_chars = 0;
+        alg_state.state = State::LOOKING_FOR_SYNC;
+    }
+
+    /**
+     * Overflow::REJECT_AT_SYNC: the rest of msg fits into free space
+     * ( bytes of chunk after cursor are already in buffer ).
+     */
+    bool fits( const struct ringbuffer& cursor ) const
+    {
+        return overflow != Overflow::REJECT_AT_SYNC ||
+               alg_state.full_msg_length - alg_state.count_received_chars <=
+               free_space() + ( rb.write_index - cursor.write_index );
+    }
+
+    /**
+     * If the descriptors queue is full, the descriptor is lost, but the buffer stays in sync
+     * as the next one knows where its msg starts.
+     */
+    void enqueue( const FrameDescriptor& frame, uint8_t priority = 0 )
+    {
+        Descriptor descriptor{};
+        static_cast<FrameDescriptor&>( descriptor ) = frame;
+        if ( descriptor.length < 0 )
+        {
+            count( irq_stats.discarded_chars, uint32_t( -descriptor.length ));
+        }
+        else if constexpr ( TIMED )
+        {
+            descriptor.times = { alg_state.sync_time, Clock::now() };
+        }
+        if ( !push_descriptor( descriptor, priority ))
+        {
+            count( irq_stats.queue_full, 1 );
+            lost_descriptors = true;
+            lost_end = descriptor.start + uint32_t( descriptor.length < 0 ? -descriptor.length : descriptor.length );
+        }
+    }
 
+    /** the thread is woken up once per push(), see wake_thread() */
+    bool push_descriptor( const Descriptor& descriptor, uint8_t priority )
+    {
+        if ( !descriptors[priority].push( descriptor ))
+        {
+            return false;
+        }
+        lost_descriptors = false;
+        queued = true;
+        return true;
+    }
+
+    /**
+     * The token is posted after every push() which queued anything, not only into empty queue: the thread could
+     * take the last descriptor right after IRQ saw the queue non-empty, then it would wait with msg in queue.
+     * CQueue holds one token, so posting it again while it's there is harmless.
+     */
+    void wake_thread( BaseType_t& pxHigherPriorityTaskWoken )
+    {
+        if ( queued )
+        {
+            queued = false;
+            int32_t token{0};
+            queue.EnqueueFromISR( &token, &pxHigherPriorityTaskWoken );
+        }
+    }
+
+    /**
+     * Bytes of lost descriptors are given back to IRQ by the next descriptor. If there is no one ( msg in progress
+     * waits for bytes, which do not fit into buffer ), a discarding descriptor for them is queued as soon as
+     * the queue has room, otherwise the buffer would stay full for ever.
+     */
+    void requeue_lost()
+    {
+        if ( lost_descriptors )
+        {
+            Descriptor lost{};
+            static_cast<FrameDescriptor&>( lost ) = { lost_end - 1, -1, 0 };
+            push_descriptor( lost, 0 );
+        }
+    }
+
+    /**
+     * The token in queue could be stale ( descriptors were taken without waiting or dropped by IRQ ),
+     * in this case the thread just waits for the next one.
+     * The descriptor is popped under lock_for_thread(), it's held if true is returned.
+     */
+    bool pop_descriptor( Descriptor& descriptor, bool wait )
+    {
+        int32_t token{0};
+        for ( ;; )
+        {
+            lock_for_thread();
+            for ( auto& descriptors_of_class: descriptors )
+            {
+                if ( descriptors_of_class.pop( descriptor ))
+                {
+                    return true;
+                }
+            }
+            unlock_for_thread();
+            if ( !wait || !queue.Dequeue( &token, timeout ))
+            {
+                return false;
+            }
+        }
+    }
+
+    bool peek( StreamFrame& frame, bool wait )
+    {
+        ASSERT( !peeked );
+        peeked = take_frame( frame, wait );
+        if ( peeked )
+        {
+            count( delivered_frames, 1 );
+        }
+        return peeked;
+    }
+
+    FrameView take_view( bool wait )
+    {
+        FrameView view;
+        if ( peek( view.frame, wait ))
+        {
+            view.owner = this;
+            view.frame_times = taken_times;
+        }
+        return view;
+    }
+
+    /**
+     * The next msg ( discarded bytes are reclaimed on the way ), waits for it only if wait is true.
+     * The msg has to be given back by release_taken().
+     */
+    bool take_frame( StreamFrame& frame, bool wait )
+    {
+        Descriptor descriptor;
+        while ( pop_descriptor( descriptor, wait ))
+        {
+            if ( descriptor.length < 0 )
+            {
+                retire( descriptor.start - descriptor.length );
+                unlock_for_thread();
+                continue;
+            }
+            uint32_t length = uint32_t( descriptor.length );
+            uint32_t offset = descriptor.start & rb.size;
+            uint32_t first = rb.size + 1 - offset;
+            if ( first > length )
+            {
+                first = length;
+            }
+            frame.first = { &rb.buf[offset], first };
+            frame.second = { rb.buf, length - first };
+            frame.protocol = descriptor.protocol;
+            if constexpr ( TIMED )
+            {
+                taken_times = descriptor.times;
+#ifdef STREAM_SEPARATOR_LATENCY_HISTOGRAM
+                receiving.record( time_point( descriptor.times.complete - descriptor.times.sync ));
+                waiting.record( time_point( Clock::now() - descriptor.times.complete ));
+#endif
+            }
+            peeked_end = descriptor.start + length;
+            return true;
+        }
+        return false;
+    }
+
+    bool verify( const struct ringbuffer& cursor, uint32_t start, uint32_t len ) const
+    {
+        return Protocols::template visit<bool>( alg_state.protocol, [&]( auto tag )
+        {
+            using Converter = typename decltype( tag )::type;
+            if constexpr ( stream_separator_detail::has_verify<Converter>::value )
+            {
+                return Converter::verify( cursor, start, len );
+            }
+            return true;
+        });
+    }
+
+    /** priority class of the received msg, converters without priority() give the last ( the lowest ) one */
+    uint8_t priority( const struct ringbuffer& cursor, uint32_t start, uint32_t len ) const
+    {
+        if constexpr ( Protocols::PRIORITIES == 1 )
+        {
+            return 0;
+        }
+        return Protocols::template visit<uint8_t>( alg_state.protocol, [&]( auto tag )
+        {
+            using Converter = typename decltype( tag )::type;
+            if constexpr ( stream_separator_detail::has_priority<Converter>::value )
+            {
+                uint32_t priority = Converter::priority( cursor, start, len );
+                return uint8_t( priority < Protocols::PRIORITIES ? priority : Protocols::PRIORITIES - 1 );
+            }
+            return uint8_t( Protocols::PRIORITIES - 1 );
+        });
+    }
+
+    /** the longest msg which could ever fit into buffer */
+    uint32_t max_msg_length() const
+    {
+        return Protocols::template visit<uint32_t>( alg_state.protocol, [&]( auto tag )
+        {
+            using Converter = typename decltype( tag )::type;
+            if constexpr ( stream_separator_detail::has_max_len<Converter>::value )
+            {
+                if ( Converter::MAX_LEN < rb.size + 1 )
+                {
+                    return uint32_t( Converter::MAX_LEN );
+                }
+            }
+            return rb.size + 1;
+        });
+    }
+
+    /** the last received bytes are the terminator of msg ( not the bytes of its sync word ) */
+    bool terminated( const struct ringbuffer& cursor ) const
+    {
+        return Protocols::template visit<bool>( alg_state.protocol, [&]( auto tag )
+        {
+            using Converter = typename decltype( tag )::type;
+            if constexpr ( stream_separator_detail::has_terminator<Converter>::value )
+            {
+                constexpr uint32_t len = sizeof( Converter::TERMINATOR ) - 1;
+                if ( alg_state.count_received_chars < Converter::LEN_OF_SYNC + len )
+                {
+                    return false;
+                }
+                for ( uint32_t i = 0; i < len; i++ )
+                {
+                    if ( rb.buf[( cursor.write_index - len + i ) & rb.size] != uint8_t( Converter::TERMINATOR[i] ))
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            }
+            return false;
+        });
+    }
+
+    /** the last byte of terminator of msg being received */
+    uint8_t terminator_end() const
+    {
+        return Protocols::template visit<uint8_t>( alg_state.protocol, []( auto tag )
+        {
+            using Converter = typename decltype( tag )::type;
+            if constexpr ( stream_separator_detail::has_terminator<Converter>::value )
+            {
+                return uint8_t( Converter::TERMINATOR[sizeof( Converter::TERMINATOR ) - 2] );
+            }
+            return uint8_t( 0 );
+        });
+    }
+
+    /** index of the first byte in [from, end) of buffer, end if there is no one */
+    uint32_t find_byte( uint32_t from, uint32_t end, uint8_t byte ) const
+    {
+        uint32_t offset = from & rb.size;
+        uint32_t first = rb.size + 1 - offset;
+        if ( first > end - from )
+        {
+            first = end - from;
+        }
+        const void* found = memchr( &rb.buf[offset], byte, first );
+        if ( found )
+        {
+            return from + uint32_t( static_cast<const uint8_t*>( found ) - &rb.buf[offset] );
+        }
+        found = memchr( rb.buf, byte, end - from - first );
+        if ( found )
+        {
+            return from + first + uint32_t( static_cast<const uint8_t*>( found ) - rb.buf );
+        }
+        return end;
+    }
+
+    /** index of the first candidate of sync word in [from, end) of buffer, end if there is no one */
+    uint32_t find_sync_candidate( uint32_t from, uint32_t end ) const
+    {
+        uint32_t offset = from & rb.size;
+        uint32_t first = rb.size + 1 - offset;
+        if ( first > end - from )
+        {
+            first = end - from;
+        }
+        uint32_t found = uint32_t( Protocols::find_any_sync( &rb.buf[offset], first ));
+        if ( found == first && first != end - from )
+        {
+            found += uint32_t( Protocols::find_any_sync( rb.buf, end - from - first ));
+        }
+        return from + found;
+    }
+
+    /**
+     * Runs the state machine over the bytes from index up to write_index.
+     * The converter looks at the last received bytes through write_index,
+     * so it goes with the cursor as if bytes were pushed one by one.
+     */
+    void process( uint32_t from )
+    {
+        // read_index of cursor is not used, it's owned by thread
+        struct ringbuffer cursor{ rb.buf, rb.size, 0, from };
+        uint32_t end = rb.write_index;
+        while ( cursor.write_index != end )
+        {
+            if constexpr ( Protocols::HAS_SYNC_PATTERN )
+            {
+                /**
+                 * Sync words which could start before the next byte are checked byte by byte,
+                 * the rest is scanned for candidates at once ( if it's worth it ).
+                 */
+                if ( alg_state.state == State::LOOKING_FOR_SYNC &&
+                     alg_state.count_received_chars >= Protocols::MAX_LEN_OF_SYNC - 1 &&
+                     end - cursor.write_index >= 16 )
+                {
+                    uint32_t scan_from = cursor.write_index - ( Protocols::MAX_LEN_OF_SYNC - 1 );
+                    /**
+                     * The byte completing the shortest sync word from candidate is processed as usual, longer ones
+                     * are completed by the next bytes. Candidate could start before the next byte, then nothing is skipped.
+                     */
+                    uint32_t candidate = find_sync_candidate( scan_from, end );
+                    uint32_t skip{0};
+                    if ( candidate + Protocols::MIN_LEN_OF_SYNC - 1 - scan_from > Protocols::MAX_LEN_OF_SYNC - 1 )
+                    {
+                        skip = candidate + Protocols::MIN_LEN_OF_SYNC - 1 - cursor.write_index;
+                    }
+                    if ( candidate == end || skip > end - cursor.write_index )
+                    {
+                        skip = end - cursor.write_index;
+                    }
+                    if ( skip != 0 )
+                    {
+                        cursor.write_index += skip;
+                        alg_state.count_received_chars += skip;
+                        continue;
+                    }
+                }
+            }
+            if ( alg_state.state == State::WAITING_FULL_MSG )
+            {
+                // nothing to check until the last byte of msg ( or of its key, if msg is filtered )
+                uint32_t check_at = alg_state.full_msg_length;
+                if ( alg_state.key_position > alg_state.count_received_chars && alg_state.key_position < check_at )
+                {
+                    check_at = alg_state.key_position;
+                }
+                if ( check_at > alg_state.count_received_chars + 1 )
+                {
+                    uint32_t skip = check_at - alg_state.count_received_chars - 1;
+                    if ( skip > end - cursor.write_index )
+                    {
+                        skip = end - cursor.write_index;
+                    }
+                    cursor.write_index += skip;
+                    alg_state.count_received_chars += skip;
+                    continue;
+                }
+            }
+            if ( alg_state.state == State::WAITING_TERMINATOR && end - cursor.write_index >= 16 )
+            {
+                // nothing to check until the last byte of terminator or the last byte msg could have
+                uint32_t limit = end;
+                if ( max_msg_length() - alg_state.count_received_chars - 1 < end - cursor.write_index )
+                {
+                    limit = cursor.write_index + max_msg_length() - alg_state.count_received_chars - 1;
+                }
+                uint32_t skip = find_byte( cursor.write_index, limit, terminator_end()) - cursor.write_index;
+                if ( skip != 0 )
+                {
+                    cursor.write_index += skip;
+                    alg_state.count_received_chars += skip;
+                    continue;
+                }
+            }
+            cursor.write_index++;
+            detect( cursor );
+            // bytes of msg dropped by filter could be given back
+            end = rb.write_index;
+        }
+
+        if ( alg_state.state == State::LOOKING_FOR_SYNC &&
+             alg_state.count_received_chars > Protocols::MAX_LEN_OF_SYNC - 1 && free_space() == 0 )
+        {
+            // noise fills the buffer, only the bytes which could be the beginning of sync word are kept
+            uint32_t noise = alg_state.count_received_chars - ( Protocols::MAX_LEN_OF_SYNC - 1 );
+            enqueue({ end - alg_state.count_received_chars, -int32_t( noise ), 0 });
+            alg_state.count_received_chars -= noise;
+        }
+    }
+
+    /** the key of msg is taken when its last byte is received */
+    void take_key( const struct ringbuffer& cursor )
+    {
+        if ( alg_state.count_received_chars == alg_state.key_position )
+        {
+            alg_state.key = Protocols::template visit<uint32_t>( alg_state.protocol, [&]( auto tag )
+            {
+                using Converter = typename decltype( tag )::type;
+                if constexpr ( stream_separator_detail::key_position_of<Converter>() != 0 )
+                {
+                    return uint32_t( Converter::get_key( cursor ));
+                }
+                return uint32_t( 0 );
+            });
+        }
+    }
+
+    /** msg passes the filter of its protocol ( or its key is not received yet ) */
+    bool accepted() const
+    {
+        if ( alg_state.key_position == 0 || alg_state.count_received_chars < alg_state.key_position ||
+             alg_state.protocol >= Protocols::COUNT )
+        {
+            return true;
+        }
+        const KeyFilter& filter = filters[alg_state.protocol];
+        bool listed = std::binary_search( filter.keys, filter.keys + filter.count, alg_state.key );
+        return listed == ( filter.mode == Filter::ALLOW );
+    }
+
+    /**
+     * The msg is dropped by filter without queuing anything: if it's the last one in buffer, its bytes are given
+     * back to IRQ at once and the rest of it is not stored at all, otherwise the bytes after it are processed
+     * and the next descriptor gives its bytes back to thread ( as bytes of lost descriptors ).
+     */
+    void drop_filtered( struct ringbuffer& cursor )
+    {
+        uint32_t start = cursor.write_index - alg_state.count_received_chars;
+        uint32_t msg_end = start + alg_state.full_msg_length;
+        count( irq_stats.filtered_frames, 1 );
+        if ( int32_t( msg_end - rb.write_index ) >= 0 )
+        {
+            skip_bytes = msg_end - rb.write_index;
+            rb.write_index = start;
+            cursor.write_index = start;
+        }
+        else
+        {
+            cursor.write_index = msg_end;
+            lost_descriptors = true;
+            lost_end = msg_end;
+        }
+        alg_state.count_received_chars = 0;
+        alg_state.state = State::LOOKING_FOR_SYNC;
+    }
+
+    /**
+     * The msg turned out to be bogus ( implausible length or failed verify() ):
+     * the first byte of false sync is discarded and the cursor goes back to look for sync
+     * among the rest of its bytes, which are still in buffer.
+     */
+    void reject( struct ringbuffer& cursor )
+    {
+        uint32_t start = cursor.write_index - alg_state.count_received_chars;
+        enqueue({ start, -1, 0 });
+        cursor.write_index = start + 1;
+        alg_state.count_received_chars = 0;
+        alg_state.state = State::LOOKING_FOR_SYNC;
+    }
+
+    void complete( struct ringbuffer& cursor )
+    {
+        uint32_t start = cursor.write_index - alg_state.count_received_chars;
+        if ( !verify( cursor, start, alg_state.count_received_chars ))
+        {
+            reject( cursor );
+            return;
+        }
+        enqueue({ start, int32_t( alg_state.count_received_chars ), alg_state.protocol },
+                priority( cursor, start, alg_state.count_received_chars ));
+        alg_state.count_received_chars = 0;
+        alg_state.state = State::LOOKING_FOR_SYNC;
+    }
+
+    /**
+     * @param cursor - ring buffer with write_index right after the byte being processed,
+     *                 moved back if msg is rejected.
+     */
+    void detect( struct ringbuffer& cursor )
+    {
         alg_state.count_received_chars++;
         switch ( alg_state.state )
         {
         case State::LOOKING_FOR_SYNC:
-            if( alg_state.count_received_chars >= StreamConverter::LEN_OF_SYNC && StreamConverter::get_sync( rb ))
+        {
+            int32_t protocol = Protocols::match_sync( cursor, alg_state.count_received_chars );
+            if( protocol >= 0 )
             {
-                int32_t counter_before_sync = 0 - (alg_state.count_received_chars - StreamConverter::LEN_OF_SYNC);
+                alg_state.protocol = uint8_t( protocol );
+                if constexpr ( TIMED )
+                {
+                    alg_state.sync_time = Clock::now();
+                }
+                uint32_t len_of_sync = Protocols::template visit<uint32_t>( alg_state.protocol, []( auto tag )
+                {
+                    return uint32_t( decltype( tag )::type::LEN_OF_SYNC );
+                });
+                int32_t counter_before_sync = 0 - (alg_state.count_received_chars - len_of_sync);
                 if ( counter_before_sync != 0 )
                 {
-                    queue.EnqueueFromISR( &counter_before_sync, &pxHigherPriorityTaskWoken );
-                    alg_state.count_received_chars = StreamConverter::LEN_OF_SYNC;
+                    enqueue({ cursor.write_index - alg_state.count_received_chars, counter_before_sync, 0 });
+                    alg_state.count_received_chars = len_of_sync;
+                }
+                alg_state.state = Protocols::template visit<State>( alg_state.protocol, [&]( auto tag )
+                {
+                    using Converter = typename decltype( tag )::type;
+                    if constexpr ( stream_separator_detail::has_fixed_len<Converter>::value )
+                    {
+                        alg_state.full_msg_length = Converter::FIXED_LEN;
+                        return State::WAITING_FULL_MSG;
+                    }
+                    else if constexpr ( stream_separator_detail::has_terminator<Converter>::value )
+                    {
+                        return State::WAITING_TERMINATOR;
+                    }
+                    return State::WAITING_LENGTH;
+                });
+                alg_state.key_position = 0;
+                // protocol is always in range here, the check lets compiler see it
+                if ( alg_state.protocol < Protocols::COUNT && filters[alg_state.protocol].keys )
+                {
+                    alg_state.key_position = Protocols::template visit<uint32_t>( alg_state.protocol, []( auto tag )
+                    {
+                        return stream_separator_detail::key_position_of<typename decltype( tag )::type>();
+                    });
+                }
+                if ( alg_state.state == State::WAITING_FULL_MSG )
+                {
+                    if ( alg_state.full_msg_length > max_msg_length())
+                    {
+                        reject( cursor );
+                    }
+                    else if ( !fits( cursor ))
+                    {
+                        count( irq_stats.dropped_overflow, 1 );
+                        reject( cursor );
+                    }
+                    else if ( alg_state.full_msg_length == alg_state.count_received_chars )
+                    {
+                        complete( cursor );
+                    }
                 }
-                alg_state.state = State::WAITING_LENGTH;
             }
             break;
+        }
 
-            /** @todo-> What about msgs with fixed length? */
         case State::WAITING_LENGTH:
-            if ( alg_state.count_received_chars == StreamConverter::BYTE_CONTAINED_LEN )
+            take_key( cursor );
+            if ( Protocols::template visit<bool>( alg_state.protocol, [&]( auto tag )
+                 {
+                     using Converter = typename decltype( tag )::type;
+                     if constexpr ( !stream_separator_detail::has_terminator<Converter>::value &&
+                                    !stream_separator_detail::has_fixed_len<Converter>::value )
+                     {
+                         if ( alg_state.count_received_chars == Converter::BYTE_CONTAINED_LEN )
+                         {
+                             alg_state.full_msg_length = Converter::get_len( cursor );
+                             return true;
+                         }
+                     }
+                     return false;
+                 }))
             {
-                alg_state.full_msg_length = StreamConverter::get_len( rb );
-                alg_state.state = State::WAITING_FULL_MSG;
+                if ( alg_state.full_msg_length < alg_state.count_received_chars ||
+                     alg_state.full_msg_length > max_msg_length())
+                {
+                    reject( cursor );
+                }
+                else if ( !accepted())
+                {
+                    drop_filtered( cursor );
+                }
+                else if ( !fits( cursor ))
+                {
+                    count( irq_stats.dropped_overflow, 1 );
+                    reject( cursor );
+                }
+                else if ( alg_state.full_msg_length == alg_state.count_received_chars )
+                {
+                    complete( cursor );
+                }
+                else
+                {
+                    alg_state.state = State::WAITING_FULL_MSG;
+                }
             }
             break;
 
         case State::WAITING_FULL_MSG:
-            if ( alg_state.count_received_chars == alg_state.full_msg_length )
+            take_key( cursor );
+            if ( alg_state.count_received_chars == alg_state.key_position && !accepted())
+            {
+                drop_filtered( cursor );
+            }
+            else if ( alg_state.count_received_chars == alg_state.full_msg_length )
             {
-                queue.EnqueueFromISR( &alg_state.count_received_chars, &pxHigherPriorityTaskWoken );
-                alg_state.count_received_chars = 0;
-                alg_state.state = State::LOOKING_FOR_SYNC;
+                complete( cursor );
+            }
+            break;
+
+        case State::WAITING_TERMINATOR:
+            if ( terminated( cursor ))
+            {
+                alg_state.full_msg_length = alg_state.count_received_chars;
+                complete( cursor );
+            }
+            else if ( alg_state.count_received_chars >= max_msg_length())
+            {
+                // not waiting for the next byte, it would not fit into buffer anyway
+                reject( cursor );
             }
             break;
 
@@ -237,11 +1687,11 @@ private:
             ASSERT(false);
             break;
         }
-        if( pxHigherPriorityTaskWoken )
-        {
-            portYIELD_FROM_ISR( pxHigherPriorityTaskWoken );
-        }
     }
 };
 
+/** Separates msgs of all listed StreamConverters from one stream in a single pass, msgs are tagged by protocol. */
+template<class CQueue, class... StreamConverters>
+using MultiStreamSeparator = StreamSeparator<CQueue, AnyOf<StreamConverters...>>;
+
 #endif //__STREAM_SEPARATOR__
@@ -0,0 +1,115 @@
+/**
+ * @author m-chichikalov@outlook.com
+ *
+ * @license  This is free chunk of code, you can do with it whatever you want;
+ *           There is no any warranty and it's posted in the hope that it will be useful.
+ *
+ * @brief Search of sync word candidates over the whole chunk of bytes.
+ *
+ * find_sync( data, len, sync ) returns the first position where the first two bytes of sync word
+ * could start: ( data[i] & mask[0] ) == sync[0] && ( data[i+1] & mask[1] ) == sync[1].
+ * The last byte of chunk is checked only against the first byte of sync, the next one is not received yet.
+ * Returns len if there is no candidate in the chunk.
+ *
+ * It's only a candidate, the final decision is made by StreamConverter::get_sync().
+ *
+ * AVX2 or SSE2 is used when the target is compiled with it ( -mavx2, x86-64 has SSE2 always ),
+ * otherwise the portable scalar loop.
+ */
+
+#ifndef __SYNC_SCANNER__
+#define __SYNC_SCANNER__
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined( __AVX2__ ) || defined( __SSE2__ )
+#include <immintrin.h>
+#endif
+
+struct SyncPattern
+{
+    uint8_t sync[2];
+    uint8_t mask[2];  /** only bits set in mask are compared; mask[1] == 0 for one byte sync */
+};
+
+namespace sync_scanner {
+
+inline size_t find_scalar( const uint8_t* data, size_t len, const SyncPattern& p, size_t from = 0 )
+{
+    for ( size_t i = from; i < len; i++ )
+    {
+        if (( data[i] & p.mask[0] ) == p.sync[0] &&
+            ( i + 1 == len || ( data[i + 1] & p.mask[1] ) == p.sync[1] ))
+        {
+            return i;
+        }
+    }
+    return len;
+}
+
+#if defined( __SSE2__ )
+inline size_t find_sse2( const uint8_t* data, size_t len, const SyncPattern& p )
+{
+    const __m128i sync0 = _mm_set1_epi8( char( p.sync[0] ));
+    const __m128i mask0 = _mm_set1_epi8( char( p.mask[0] ));
+    const __m128i sync1 = _mm_set1_epi8( char( p.sync[1] ));
+    const __m128i mask1 = _mm_set1_epi8( char( p.mask[1] ));
+
+    size_t i = 0;
+    // the second byte is loaded with offset 1, so one more byte has to be in the chunk
+    for ( ; i + 17 <= len; i += 16 )
+    {
+        __m128i first  = _mm_loadu_si128( reinterpret_cast<const __m128i*>( data + i ));
+        __m128i second = _mm_loadu_si128( reinterpret_cast<const __m128i*>( data + i + 1 ));
+        __m128i match  = _mm_and_si128( _mm_cmpeq_epi8( _mm_and_si128( first, mask0 ), sync0 ),
+                                        _mm_cmpeq_epi8( _mm_and_si128( second, mask1 ), sync1 ));
+        uint32_t bits = uint32_t( _mm_movemask_epi8( match ));
+        if ( bits )
+        {
+            return i + uint32_t( __builtin_ctz( bits ));
+        }
+    }
+    return find_scalar( data, len, p, i );
+}
+#endif
+
+#if defined( __AVX2__ )
+inline size_t find_avx2( const uint8_t* data, size_t len, const SyncPattern& p )
+{
+    const __m256i sync0 = _mm256_set1_epi8( char( p.sync[0] ));
+    const __m256i mask0 = _mm256_set1_epi8( char( p.mask[0] ));
+    const __m256i sync1 = _mm256_set1_epi8( char( p.sync[1] ));
+    const __m256i mask1 = _mm256_set1_epi8( char( p.mask[1] ));
+
+    size_t i = 0;
+    for ( ; i + 33 <= len; i += 32 )
+    {
+        __m256i first  = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( data + i ));
+        __m256i second = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( data + i + 1 ));
+        __m256i match  = _mm256_and_si256( _mm256_cmpeq_epi8( _mm256_and_si256( first, mask0 ), sync0 ),
+                                           _mm256_cmpeq_epi8( _mm256_and_si256( second, mask1 ), sync1 ));
+        uint32_t bits = uint32_t( _mm256_movemask_epi8( match ));
+        if ( bits )
+        {
+            return i + uint32_t( __builtin_ctz( bits ));
+        }
+    }
+    return i + find_sse2( data + i, len - i, p );
+}
+#endif
+
+} // namespace sync_scanner
+
+inline size_t find_sync( const uint8_t* data, size_t len, const SyncPattern& p )
+{
+#if defined( __AVX2__ )
+    return sync_scanner::find_avx2( data, len, p );
+#elif defined( __SSE2__ )
+    return sync_scanner::find_sse2( data, len, p );
+#else
+    return sync_scanner::find_scalar( data, len, p );
+#endif
+}
+
+#endif //__SYNC_SCANNER__
@@ -0,0 +1,442 @@
+/**
+ * Fuzzing of StreamSeparator: input is a program of calls push( data ), push( byte ), next(), peek_frame(),
+ * release_frame(), next_batch(), flush() with arbitrary bytes, run on small buffer and queue, so they wrap
+ * around and overflow all the time.
+ *
+ * Every msg delivered is cross-checked against the reference framer - plain loop over all bytes accepted into
+ * buffer since flush(). While no descriptor was lost ( queue full ) msgs have to be the same and in the same
+ * order, otherwise msgs have to be a subsequence of reference ones. The caller buffer of next() has exactly the
+ * size passed, so any overrun is caught by ASan. At the end of input the separator has to deliver valid msgs
+ * again, without flush() and after it.
+ *
+ * libFuzzer:
+ *  clang++ -g -O1 -std=c++17 -fsanitize=fuzzer,address,undefined -D_UNIT_TEST_ -I. -Itests/test_doubles/ring_buffer \
+ *      tests/fuzz/fuzz_separator.cpp tests/test_doubles/ring_buffer/utils_ringbuffer.c -o fuzz_separator -pthread
+ *  ./fuzz_separator -max_len=4096 corpus_dir
+ *
+ * AFL or replay of crashes ( files from arguments, stdin if none ), add -DFUZZ_MAIN:
+ *  g++ -g -O1 -std=c++17 -fsanitize=address,undefined -DFUZZ_MAIN -D_UNIT_TEST_ -I. -Itests/test_doubles/ring_buffer \
+ *      tests/fuzz/fuzz_separator.cpp tests/test_doubles/ring_buffer/utils_ringbuffer.c -o fuzz_separator -pthread
+ *  afl-fuzz -i seeds -o findings -- ./fuzz_separator @@
+ *
+ * -DFUZZ_MAIN with --random N runs N random programs, for a quick run without fuzzer.
+ */
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "tests/test_doubles/ring_buffer/utils_ringbuffer.h"
+#include "tests/test_doubles/ubx_stream_separator.hpp"
+#include "tests/test_doubles/rtcm3_stream_separator.hpp"
+
+#include "posix_backend.hpp"
+#include "stream_separator.hpp"
+
+#define FUZZ_CHECK(x) do { if ( !( x )) { fprintf( stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #x ); abort(); } } while ( 0 )
+
+namespace {
+    constexpr uint32_t RING_SIZE = 256;
+    constexpr uint32_t QUEUE_DEPTH = 8;
+    constexpr uint8_t ANY_PROTOCOL = 0xFF;
+
+    using Separator = StreamSeparator<PosixQueue, AnyOf<UBX_Checked_Msg, RTCM_Msg>, QUEUE_DEPTH>;
+
+    struct Frame
+    {
+        std::vector<uint8_t> bytes;
+        uint8_t protocol;  /** ANY_PROTOCOL for msgs of next() */
+
+        bool operator==( const Frame& other ) const
+        {
+            return ( protocol == other.protocol || protocol == ANY_PROTOCOL || other.protocol == ANY_PROTOCOL ) &&
+                   bytes == other.bytes;
+        }
+    };
+
+    Frame copy( const StreamFrame& frame )
+    {
+        Frame copied{ std::vector<uint8_t>( frame.first.data, frame.first.data + frame.first.size ), frame.protocol };
+        copied.bytes.insert( copied.bytes.end(), frame.second.data, frame.second.data + frame.second.size );
+        return copied;
+    }
+
+    /**
+     * The same framing written as simple as it could be: sync is looked for from the start of stream, after
+     * every msg and from the byte after sync of every bogus msg ( too long or failed checksum ).
+     */
+    std::vector<Frame> reference( const std::vector<uint8_t>& s, uint32_t max_len )
+    {
+        std::vector<Frame> frames;
+        size_t start{0};
+        while ( start + 2 <= s.size())
+        {
+            bool ubx = s[start] == 0xb5 && s[start + 1] == 0x62;
+            bool rtcm = s[start] == 0xd3 && ( s[start + 1] & 0xfc ) == 0;
+            if ( !ubx && !rtcm )
+            {
+                start++;
+                continue;
+            }
+            size_t header = ubx ? 6 : 3;
+            if ( start + header > s.size())
+            {
+                break;
+            }
+            size_t len = ubx ? ( s[start + 4] | s[start + 5] << 8 ) + 8 : (( s[start + 1] & 3 ) << 8 | s[start + 2] ) + 6;
+            if ( len > max_len )
+            {
+                start++;
+                continue;
+            }
+            if ( start + len > s.size())
+            {
+                break;
+            }
+            struct ringbuffer rb{ const_cast<uint8_t*>( s.data()), 0xFFFFFFFFU, 0, uint32_t( s.size()) };
+            bool valid = ubx ? UBX_Checked_Msg::verify( rb, uint32_t( start ), uint32_t( len ))
+                             : RTCM_Msg::verify( rb, uint32_t( start ), uint32_t( len ));
+            if ( !valid )
+            {
+                start++;
+                continue;
+            }
+            frames.push_back({ std::vector<uint8_t>( &s[start], &s[start + len] ), uint8_t( ubx ? 0 : 1 )});
+            start += len;
+        }
+        return frames;
+    }
+
+    /** reads the program, missing bytes are zeros */
+    class Program
+    {
+    public:
+        Program( const uint8_t* data, size_t size ): data{ data }, size{ size } {};
+
+        bool done() const { return pos >= size; }
+        uint8_t byte() { return pos < size ? data[pos++] : 0; }
+        size_t take( const uint8_t*& from, size_t len )
+        {
+            from = data + pos;
+            len = std::min( len, size - std::min( pos, size ));
+            pos += len;
+            return len;
+        }
+
+    private:
+        const uint8_t* data;
+        size_t size;
+        size_t pos{0};
+    };
+
+    class Harness
+    {
+    public:
+        Harness()
+        {
+            separator.buffer( ring.data(), RING_SIZE ).create();
+            reset();
+        }
+
+        void run( Program& program )
+        {
+            while ( !program.done())
+            {
+                switch ( program.byte() % 8 )
+                {
+                    case 0:
+                    {
+                        const uint8_t* data;
+                        size_t len = program.take( data, program.byte());
+                        push( data, len );
+                        break;
+                    }
+                    case 1:
+                    {
+                        uint8_t byte = program.byte();
+                        push( &byte, 1, true );
+                        break;
+                    }
+                    case 2: next( program.byte()); break;
+                    case 3: peek(); break;
+                    case 4: release(); break;
+                    case 5: batch( program.byte() % 4 + 1 ); break;
+                    case 6: flush(); break;
+                    default:
+                    {
+                        bool rtcm = program.byte() & 1;
+                        const uint8_t* payload;
+                        size_t len = program.take( payload, program.byte() % 64 );
+                        std::vector<uint8_t> msg = valid_msg( rtcm, payload, len );
+                        push( msg.data(), msg.size());
+                        break;
+                    }
+                }
+            }
+            recovers();
+        }
+
+    private:
+        std::vector<uint8_t> ring = std::vector<uint8_t>( RING_SIZE );
+        Separator separator;
+
+        std::vector<uint8_t> accepted;   /** bytes taken into buffer since flush() */
+        std::vector<Frame> expected;     /** reference msgs of accepted bytes */
+        size_t matched{0};               /** reference msgs already delivered or passed */
+        uint32_t queue_full_at_flush{0};
+        bool peeked{ false };
+
+        void reset()
+        {
+            accepted.clear();
+            expected.clear();
+            matched = 0;
+            queue_full_at_flush = separator.stats().queue_full;
+        }
+
+        /** no descriptor lost since flush() */
+        bool exact() const { return separator.stats().queue_full == queue_full_at_flush; }
+
+        void push( const uint8_t* data, size_t len, bool by_byte = false )
+        {
+            uint32_t missed = separator.stats().missed_chars;
+            if ( by_byte )
+            {
+                separator.push( *data );
+            }
+            else
+            {
+                separator.push( data, len );
+            }
+            // only the beginning of chunk, which fits into buffer, is taken
+            size_t taken = len - ( separator.stats().missed_chars - missed );
+            FUZZ_CHECK( taken <= len );
+            accepted.insert( accepted.end(), data, data + taken );
+            expected = reference( accepted, RING_SIZE );
+            FUZZ_CHECK( separator.stats().ring_high_water <= RING_SIZE );
+        }
+
+        /** the msg is the next reference one, msgs dropped by next() before it are too long for its buffer */
+        void delivered( const Frame& frame, uint32_t dropped, uint32_t size )
+        {
+            if ( exact())
+            {
+                for ( uint32_t i = 0; i < dropped; i++ )
+                {
+                    FUZZ_CHECK( matched < expected.size() && expected[matched].bytes.size() > size );
+                    matched++;
+                }
+                FUZZ_CHECK( matched < expected.size() && expected[matched] == frame );
+                matched++;
+                return;
+            }
+            while ( matched < expected.size() && !( expected[matched] == frame ))
+            {
+                matched++;
+            }
+            FUZZ_CHECK( matched < expected.size());
+            matched++;
+        }
+
+        /** there is no msg in queue, so all reference msgs were delivered unless descriptors were lost */
+        void drained( uint32_t dropped, uint32_t size )
+        {
+            if ( exact())
+            {
+                for ( uint32_t i = 0; i < dropped; i++ )
+                {
+                    FUZZ_CHECK( matched < expected.size() && expected[matched].bytes.size() > size );
+                    matched++;
+                }
+                FUZZ_CHECK( matched == expected.size());
+            }
+        }
+
+        void next( uint32_t size )
+        {
+            release();
+            std::vector<uint8_t> buff( size );
+            uint32_t dropped = separator.stats().dropped_oversize;
+            int32_t len = separator.next( buff.data(), size );
+            dropped = separator.stats().dropped_oversize - dropped;
+            FUZZ_CHECK( len >= 0 && uint32_t( len ) <= size );
+            if ( len == 0 )
+            {
+                drained( dropped, size );
+                return;
+            }
+            delivered({ std::vector<uint8_t>( buff.begin(), buff.begin() + len ), ANY_PROTOCOL }, dropped, size );
+        }
+
+        void peek()
+        {
+            if ( peeked )
+            {
+                return;
+            }
+            StreamFrame frame;
+            peeked = separator.peek_frame( frame );
+            if ( !peeked )
+            {
+                drained( 0, 0 );
+                return;
+            }
+            FUZZ_CHECK( frame.length() <= RING_SIZE );
+            delivered( copy( frame ), 0, 0 );
+        }
+
+        void release()
+        {
+            if ( peeked )
+            {
+                separator.release_frame();
+                peeked = false;
+            }
+        }
+
+        void batch( uint32_t max_frames )
+        {
+            release();
+            std::vector<Frame> frames;
+            auto sink = [&]( const StreamFrame& frame ) { frames.push_back( copy( frame )); };
+            uint32_t taken = separator.next_batch( sink, max_frames );
+            FUZZ_CHECK( taken == frames.size() && taken <= max_frames );
+            for ( const auto& frame: frames )
+            {
+                delivered( frame, 0, 0 );
+            }
+            if ( taken < max_frames )
+            {
+                drained( 0, 0 );
+            }
+        }
+
+        void flush()
+        {
+            separator.flush();
+            peeked = false;
+            reset();
+        }
+
+        /** UBX or RTCM3 msg with correct checksum, len < 256 */
+        static std::vector<uint8_t> valid_msg( bool rtcm, const uint8_t* payload, size_t len )
+        {
+            std::vector<uint8_t> msg;
+            if ( rtcm )
+            {
+                msg = { 0xd3, 0x00, uint8_t( len )};
+            }
+            else
+            {
+                msg = { 0xb5, 0x62, 0x02, 0x15, uint8_t( len ), 0x00 };
+            }
+            msg.insert( msg.end(), payload, payload + len );
+            struct ringbuffer rb{ msg.data(), 0xFFFFFFFFU, 0, uint32_t( msg.size()) };
+            if ( rtcm )
+            {
+                uint32_t crc = crc24q( rb, 0, uint32_t( msg.size()));
+                msg.insert( msg.end(), { uint8_t( crc >> 16 ), uint8_t( crc >> 8 ), uint8_t( crc )});
+            }
+            else
+            {
+                uint16_t ck = fletcher8( rb, 2, uint32_t( msg.size()) - 2 );
+                msg.insert( msg.end(), { uint8_t( ck ), uint8_t( ck >> 8 )});
+            }
+            return msg;
+        }
+
+        /**
+         * Whatever happened before, valid msgs pushed while the thread keeps up with them are delivered:
+         * a bogus msg in progress could swallow at most the buffer of them.
+         */
+        void recovers()
+        {
+            for ( int with_flush = 0; with_flush < 2; with_flush++ )
+            {
+                release();
+                batch( QUEUE_DEPTH + 1 );
+                if ( with_flush )
+                {
+                    flush();
+                }
+                bool found{ false };
+                for ( uint8_t i = 0; i < 2 * RING_SIZE / 16; i++ )
+                {
+                    const uint8_t payload[4] = { 0x70, 0x72, uint8_t( with_flush ), i };
+                    std::vector<uint8_t> msg = valid_msg( false, payload, sizeof( payload ));
+                    push( msg.data(), msg.size());
+                    Frame last{ msg, 0 };
+                    found = false;
+                    std::vector<Frame> frames;
+                    auto sink = [&]( const StreamFrame& frame ) { frames.push_back( copy( frame )); };
+                    while ( separator.next_batch( sink, QUEUE_DEPTH ) != 0 );
+                    for ( const auto& frame: frames )
+                    {
+                        delivered( frame, 0, 0 );
+                        found = found || frame == last;
+                    }
+                }
+                FUZZ_CHECK( found );
+            }
+        }
+    };
+}
+
+extern "C" int LLVMFuzzerTestOneInput( const uint8_t* data, size_t size )
+{
+    Program program( data, size );
+    Harness harness;
+    harness.run( program );
+    return 0;
+}
+
+#ifdef FUZZ_MAIN
+int main( int argc, char** argv )
+{
+    if ( argc == 3 && strcmp( argv[1], "--random" ) == 0 )
+    {
+        std::mt19937 gen( 1 );
+        unsigned long runs = strtoul( argv[2], nullptr, 10 );
+        for ( unsigned long i = 0; i < runs; i++ )
+        {
+            std::vector<uint8_t> input( gen() % 4096 );
+            for ( auto& byte: input )
+            {
+                byte = uint8_t( gen());
+            }
+            LLVMFuzzerTestOneInput( input.data(), input.size());
+        }
+        return 0;
+    }
+
+    std::vector<FILE*> inputs;
+    for ( int i = 1; i < argc; i++ )
+    {
+        FILE* file = fopen( argv[i], "rb" );
+        if ( !file )
+        {
+            perror( argv[i] );
+            return 1;
+        }
+        inputs.push_back( file );
+    }
+    if ( inputs.empty())
+    {
+        inputs.push_back( stdin );
+    }
+    for ( FILE* file: inputs )
+    {
+        std::vector<uint8_t> input;
+        uint8_t chunk[4096];
+        size_t len;
+        while (( len = fread( chunk, 1, sizeof( chunk ), file )) != 0 )
+        {
+            input.insert( input.end(), chunk, chunk + len );
+        }
+        LLVMFuzzerTestOneInput( input.data(), input.size());
+    }
+    return 0;
+}
+#endif
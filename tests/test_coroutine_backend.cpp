@@ -0,0 +1,182 @@
+#if __cplusplus >= 202002L
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+/** including doubles */
+#include "tests/test_doubles/ring_buffer/utils_ringbuffer.h"
+#include "tests/test_doubles/ubx_stream_separator.hpp"
+
+/** including files under test */
+    #include "coroutine_backend.hpp"
+    #include "stream_separator.hpp"
+
+namespace {
+    constexpr std::array<uint8_t, 18> ubx_18{ 0xb5, 0x62, 0x01, 0x3b, 0x0a, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x46, 0x85 };
+
+    using Separator = StreamSeparator<AsyncQueue, UBX_Checked_Msg, 64>;
+
+    /** source of IsrThread giving count msgs after delay */
+    auto delayed_msgs( uint32_t count )
+    {
+        return [count, sent = false]( uint8_t* buf, size_t ) mutable -> size_t
+        {
+            if ( sent )
+            {
+                return 0;
+            }
+            sent = true;
+            std::this_thread::sleep_for( std::chrono::milliseconds( 20 ));
+            for ( uint32_t i = 0; i < count; i++ )
+            {
+                memcpy( &buf[i * ubx_18.size()], ubx_18.data(), ubx_18.size());
+            }
+            return count * ubx_18.size();
+        };
+    }
+
+    /**
+     * source of IsrThread giving msgs one by one as soon as they are taken, so the coroutine is suspended
+     * and resumed all the time. If msgs are not taken for long, the loop is stopped instead of hanging.
+     */
+    auto streamed_msgs( Separator& stream, LoopExecutor& loop, uint32_t count )
+    {
+        return [&stream, &loop, count, sent = uint32_t( 0 )]( uint8_t* buf, size_t ) mutable -> size_t
+        {
+            // the last msgs have to be taken too
+            uint32_t ahead = sent == count ? 0 : 32;
+            auto since = std::chrono::steady_clock::now();
+            while ( stream.stats().delivered_frames + ahead < sent )
+            {
+                if ( std::chrono::steady_clock::now() - since > std::chrono::milliseconds( 500 ))
+                {
+                    loop.stop();
+                    return 0;
+                }
+                std::this_thread::yield();
+            }
+            if ( sent == count )
+            {
+                return 0;
+            }
+            sent++;
+            memcpy( buf, ubx_18.data(), ubx_18.size());
+            return ubx_18.size();
+        };
+    }
+
+    // coroutines are free functions, captures of lambda would not outlive the first suspension
+    Detached read_one( Separator& stream, LoopExecutor& loop, uint32_t& len, std::thread::id& resumed_on )
+    {
+        auto view = co_await stream.async_next( loop );
+        len = view ? view->length() : 0;
+        resumed_on = std::this_thread::get_id();
+        loop.stop();
+    }
+
+    Detached read_some( Separator& stream, LoopExecutor& loop, uint32_t& count, uint32_t limit )
+    {
+        auto msgs = frames( stream, loop );
+        while ( auto view = co_await msgs.next())
+        {
+            EXPECT_EQ( view->length(), uint32_t( ubx_18.size()));
+            if ( ++count == limit )
+            {
+                break;
+            }
+        }
+        loop.stop();
+    }
+};
+
+class Coroutine_Backend_CUT: public ::testing::Test
+{
+public:
+    Coroutine_Backend_CUT()
+    {
+        stream.buffer( ring.data(), ring.size()).create();
+    };
+
+protected:
+    std::array<uint8_t, 1024> ring{0};
+    Separator stream;
+    LoopExecutor loop;
+};
+
+TEST_F( Coroutine_Backend_CUT, AsyncNextReadyWhenMsgIsQueued )
+{
+    stream.push( ubx_18.data(), ubx_18.size());
+
+    uint32_t len{0};
+    std::thread::id resumed_on;
+    read_one( stream, loop, len, resumed_on );
+    EXPECT_EQ( len, uint32_t( ubx_18.size()));
+};
+
+TEST_F( Coroutine_Backend_CUT, AsyncNextResumedOnExecutorOfCaller )
+{
+    uint32_t len{0};
+    std::thread::id resumed_on;
+    read_one( stream, loop, len, resumed_on );
+    EXPECT_EQ( len, uint32_t( 0 ));
+
+    IsrThread irq( stream, delayed_msgs( 1 ));
+    loop.run();
+    irq.join();
+
+    EXPECT_EQ( len, uint32_t( ubx_18.size()));
+    EXPECT_EQ( resumed_on, std::this_thread::get_id());
+};
+
+/** timeout of separator is for blocking next(), the coroutine is suspended at once */
+TEST_F( Coroutine_Backend_CUT, AsyncNextDoesNotWaitForTimeout )
+{
+    stream.set_timeout( 500 );
+
+    uint32_t len{0};
+    std::thread::id resumed_on;
+    auto started = std::chrono::steady_clock::now();
+    read_one( stream, loop, len, resumed_on );
+    EXPECT_LT( std::chrono::steady_clock::now() - started, std::chrono::milliseconds( 250 ));
+    EXPECT_EQ( len, uint32_t( 0 ));
+
+    IsrThread irq( stream, delayed_msgs( 1 ));
+    loop.run();
+    irq.join();
+
+    EXPECT_EQ( len, uint32_t( ubx_18.size()));
+};
+
+TEST_F( Coroutine_Backend_CUT, GeneratorStreamsAllMsgs )
+{
+    uint32_t count{0};
+    read_some( stream, loop, count, 5 );
+
+    IsrThread irq( stream, delayed_msgs( 5 ));
+    loop.run();
+    irq.join();
+
+    EXPECT_EQ( count, uint32_t( 5 ));
+};
+
+/** every msg wakes up the suspended coroutine, none is left in queue until the next one comes */
+TEST_F( Coroutine_Backend_CUT, GeneratorIsWokenUpByEveryMsgWhileIsrThreadIsStreaming )
+{
+    uint32_t count{0};
+    read_some( stream, loop, count, 20000 );
+
+    IsrThread irq( stream, streamed_msgs( stream, loop, 20000 ));
+    loop.run();
+    irq.join();
+
+    EXPECT_EQ( count, uint32_t( 20000 ));
+    EXPECT_EQ( stream.stats().queue_full, uint32_t( 0 ));
+};
+
+#endif // C++20 coroutines
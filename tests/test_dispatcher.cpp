@@ -0,0 +1,164 @@
+#include <array>
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+/** including doubles */
+#include "tests/test_doubles/ring_buffer/utils_ringbuffer.h"
+#include "tests/test_doubles/queue/dummy_queue.hpp"
+#include "tests/test_doubles/imu_stream_separator.hpp"
+#include "tests/test_doubles/ubx_stream_separator.hpp"
+#include "tests/test_doubles/rtcm3_stream_separator.hpp"
+#include "tests/test_doubles/rtos_stubs.hpp"
+
+/** including files under test */
+    #include "stream_separator.hpp"
+    #include "dispatcher.hpp"
+
+namespace {
+    constexpr std::array<uint8_t, 10> imu_1{ 0xaa, 0x55, 0x01, 0x10, 0x00, 0x20, 0x00, 0x30, 0x00, 0x61 };
+
+    // msg 1005 from RTCM 10403 example
+    constexpr std::array<uint8_t, 25> msg_1005{ 0xd3, 0x00, 0x13, 0x3e, 0xd7, 0xd3, 0x02, 0x02, 0x98, 0x0e, 0xde,
+            0xef, 0x34, 0xb4, 0xbd, 0x62, 0xac, 0x09, 0x41, 0x98, 0x6f, 0x33, 0x36, 0x0b, 0x98 };
+
+    /** UBX msg of 18 bytes with its number in payload, UBX_Msg does not check checksum */
+    std::vector<uint8_t> ubx( uint32_t key, uint8_t number )
+    {
+        std::vector<uint8_t> msg{ 0xb5, 0x62, uint8_t( key >> 8 ), uint8_t( key ), 0x0a, 0x00 };
+        msg.resize( 18, 0x00 );
+        msg[6] = number;
+        return msg;
+    }
+
+    /** keeps numbers of msgs it was called with */
+    template<uint32_t key>
+    struct Recorder
+    {
+        static constexpr uint32_t KEY = key;
+        void operator()( const StreamFrame& frame )
+        {
+            numbers.push_back( frame[6] );
+            length = frame.length();
+        }
+        std::vector<uint8_t> numbers;
+        uint32_t length{0};
+    };
+
+    using OnNavPvt = Recorder<0x0107>;
+    using OnRawx = Recorder<0x0215>;
+    using OnNavSat = Recorder<0x0135>;
+
+    struct On1005
+    {
+        static constexpr uint32_t KEY = 1005;
+        void operator()( const StreamFrame& frame ) { lengths.push_back( frame.length()); }
+        std::vector<uint32_t> lengths;
+    };
+};
+
+class Dispatcher_CUT: public ::testing::Test
+{
+public:
+    Dispatcher_CUT()
+    {
+        stream.buffer( ring.data(), ring.size()).create();
+    };
+
+protected:
+    void push( const std::vector<uint8_t>& bytes )
+    {
+        stream.push( bytes.data(), bytes.size());
+    }
+
+    std::array<uint8_t, 256> ring{0};
+    StreamSeparator<DummyQueue, UBX_Msg> stream;
+    // handlers are listed out of order of their keys
+    Dispatcher<UBX_Msg, OnRawx, OnNavPvt, OnNavSat> dispatcher;
+};
+
+TEST_F( Dispatcher_CUT, EveryMsgGoesToHandlerOfItsKey )
+{
+    push( ubx( 0x0215, 1 ));
+    push( ubx( 0x0107, 2 ));
+    push( ubx( 0x0135, 3 ));
+    push( ubx( 0x0107, 4 ));
+
+    EXPECT_EQ( dispatcher.poll( stream, 16 ), uint32_t( 4 ));
+    EXPECT_EQ( dispatcher.handler<OnNavPvt>().numbers, std::vector<uint8_t>({ 2, 4 }));
+    EXPECT_EQ( dispatcher.handler<OnRawx>().numbers, std::vector<uint8_t>({ 1 }));
+    EXPECT_EQ( dispatcher.handler<OnNavSat>().numbers, std::vector<uint8_t>({ 3 }));
+    EXPECT_EQ( dispatcher.handler<OnNavSat>().length, uint32_t( 18 ));
+    EXPECT_EQ( dispatcher.unhandled(), uint32_t( 0 ));
+};
+
+TEST_F( Dispatcher_CUT, MsgsWithoutHandlerAreCounted )
+{
+    push( ubx( 0x0106, 1 ));  // right below NAV-PVT
+    push( ubx( 0x0a04, 2 ));  // above all keys
+    push( ubx( 0x0100, 3 ));  // below all keys
+    push( ubx( 0x0107, 4 ));
+
+    EXPECT_EQ( dispatcher.poll( stream, 16 ), uint32_t( 4 ));
+    EXPECT_EQ( dispatcher.handler<OnNavPvt>().numbers, std::vector<uint8_t>({ 4 }));
+    EXPECT_EQ( dispatcher.unhandled(), uint32_t( 3 ));
+};
+
+TEST_F( Dispatcher_CUT, MsgWrappingAroundBufferIsDispatchedByItsKey )
+{
+    std::array<uint8_t, 32> ring_32{0};
+    stream.buffer( ring_32.data(), ring_32.size()).create();
+
+    // the key of the second msg is split by the end of buffer
+    push( std::vector<uint8_t>( 11, 0x00 ));
+    push( ubx( 0x0215, 1 ));
+    EXPECT_EQ( dispatcher.poll( stream, 16 ), uint32_t( 1 ));
+    push( ubx( 0x0107, 2 ));
+    EXPECT_EQ( dispatcher.poll( stream, 16 ), uint32_t( 1 ));
+
+    EXPECT_EQ( dispatcher.handler<OnRawx>().numbers, std::vector<uint8_t>({ 1 }));
+    EXPECT_EQ( dispatcher.handler<OnNavPvt>().numbers, std::vector<uint8_t>({ 2 }));
+};
+
+/** the same as Dispatcher_CUT, but frames are taken by user */
+TEST_F( Dispatcher_CUT, DispatcherIsSinkOfFrames )
+{
+    push( ubx( 0x0135, 1 ));
+    push( ubx( 0x0a04, 2 ));
+
+    StreamFrame frame;
+    ASSERT_TRUE( stream.peek_frame( frame ));
+    EXPECT_TRUE( dispatcher( frame ));
+    stream.release_frame();
+
+    auto view = stream.next_frame();
+    ASSERT_TRUE( view );
+    EXPECT_FALSE( dispatcher( *view ));
+    EXPECT_EQ( dispatcher.handler<OnNavSat>().numbers, std::vector<uint8_t>({ 1 }));
+};
+
+TEST( Dispatcher, MsgsOfOtherProtocolsAreSkipped )
+{
+    std::array<uint8_t, 256> ring{0};
+    MultiStreamSeparator<DummyQueue, IMU_Msg, UBX_Msg, RTCM_Msg> stream;
+    stream.buffer( ring.data(), ring.size()).create();
+
+    Dispatcher<UBX_Msg, OnNavPvt> ubx_dispatcher;
+    Dispatcher<RTCM_Msg, On1005> rtcm_dispatcher;
+
+    std::vector<uint8_t> chunk( msg_1005.begin(), msg_1005.end());
+    auto pvt = ubx( 0x0107, 1 );
+    chunk.insert( chunk.end(), pvt.begin(), pvt.end());
+    chunk.insert( chunk.end(), imu_1.begin(), imu_1.end());
+    stream.push( chunk.data(), chunk.size());
+    EXPECT_EQ( ubx_dispatcher.poll( stream, 16 ), uint32_t( 3 ));
+    EXPECT_EQ( ubx_dispatcher.handler<OnNavPvt>().numbers, std::vector<uint8_t>({ 1 }));
+
+    stream.push( chunk.data(), chunk.size());
+    EXPECT_EQ( rtcm_dispatcher.poll( stream, 16 ), uint32_t( 3 ));
+    EXPECT_EQ( rtcm_dispatcher.handler<On1005>().lengths, std::vector<uint32_t>({ 25 }));
+
+    EXPECT_EQ( ubx_dispatcher.unhandled(), uint32_t( 0 ));
+    EXPECT_EQ( rtcm_dispatcher.unhandled(), uint32_t( 0 ));
+};
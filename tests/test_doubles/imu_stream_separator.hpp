@@ -0,0 +1,33 @@
+#ifndef __IMU_MSG
+#define __IMU_MSG
+
+#include "sync_scanner.hpp"
+
+/** proprietary IMU packet of constant size: 0xaa:0x55:SEQ:GYRO_XYZ(6):CS, CS is sum of bytes after sync */
+struct IMU_Msg
+{
+    IMU_Msg() = delete;
+    ~IMU_Msg() = delete;
+
+    static constexpr uint32_t FIXED_LEN = 10;
+    static constexpr uint32_t LEN_OF_SYNC = 2;
+    static constexpr SyncPattern SYNC_PATTERN{{ 0xaa, 0x55 }, { 0xff, 0xff }};
+
+    static bool get_sync( const struct ringbuffer& rb)
+    {
+        return rb.buf[( rb.write_index - 1 ) & rb.size] == 0x55 &&
+               rb.buf[( rb.write_index - 2 ) & rb.size] == 0xaa;
+    }
+
+    static bool verify( const struct ringbuffer& rb, uint32_t index, uint32_t len )
+    {
+        uint8_t sum{0};
+        for ( uint32_t i = 2; i < len - 1; i++ )
+        {
+            sum += rb.buf[( index + i ) & rb.size];
+        }
+        return sum == rb.buf[( index + len - 1 ) & rb.size];
+    }
+};
+
+#endif //__IMU_MSG
@@ -0,0 +1,42 @@
+#ifndef __NMEA_MSG
+#define __NMEA_MSG
+
+#include "checksum.hpp"
+#include "sync_scanner.hpp"
+
+/** NMEA-0183 sentence: $TALKER_AND_TYPE,FIELDS...*hh\r\n, checksum is optional */
+struct NMEA_Msg
+{
+    NMEA_Msg() = delete;
+    ~NMEA_Msg() = delete;
+
+    static constexpr uint32_t LEN_OF_SYNC = 1;
+    static constexpr SyncPattern SYNC_PATTERN{{ '$', 0x00 }, { 0xff, 0x00 }};
+    static constexpr char TERMINATOR[] = "\r\n";
+    static constexpr uint32_t MAX_LEN = 82;
+
+    static bool get_sync( const struct ringbuffer& rb)
+    {
+        return rb.buf[( rb.write_index - 1 ) & rb.size] == '$';
+    }
+
+    /** XOR of all chars between '$' and '*' equals to hh */
+    static bool verify( const struct ringbuffer& rb, uint32_t index, uint32_t len )
+    {
+        if ( len < 6 || rb.buf[( index + len - 5 ) & rb.size] != '*' )
+        {
+            return true;
+        }
+        uint8_t hh = uint8_t(( hex( rb.buf[( index + len - 4 ) & rb.size] ) << 4 ) |
+                               hex( rb.buf[( index + len - 3 ) & rb.size] ));
+        return xor8( rb, index + 1, len - 6 ) == hh;
+    }
+
+private:
+    static uint8_t hex( uint8_t c )
+    {
+        return c <= '9' ? c - '0' : ( c & ~0x20 ) - 'A' + 10;
+    }
+};
+
+#endif //__NMEA_MSG
@@ -1,29 +1,25 @@
 #ifndef __RTCM3_MSG
 #define __RTCM3_MSG
 
-struct RTCM_Msg
-{
-    RTCM_Msg() = delete;
-    ~RTCM_Msg() = delete;
+#include "checksum.hpp"
+#include "protocol_descriptor.hpp"
 
-    static constexpr uint32_t BYTE_CONTAINED_LEN = 3;
-    static constexpr uint32_t LEN_OF_SYNC = 2;
+/** RTCM3 frame: 0xd3:6 reserved bits:10 bits of length:PAYLOAD:CRC-24Q, key is 12 bits of msg number */
+inline constexpr ProtocolDescriptor RTCM3_DESCRIPTOR{
+    { 0xd3, 0x00 }, { 0xff, 0xfc }, 2,
+    1, 10, 0, Endian::BIG,
+    6,
+    3, 12, 4, Endian::BIG };
 
-    static uint32_t get_len( const struct ringbuffer& rb)
-    {
-        /** @todo > FIXME */
-        /** There is a bug. Messages longer than 255 bytes will not work */
-        return rb.buf[( rb.write_index - 1 ) & rb.size] + 6;
-    }
-
-    static bool get_sync( const struct ringbuffer& rb)
+struct RTCM_Msg: DescribedMsg<RTCM3_DESCRIPTOR>
+{
+    /** CRC-24Q over header and payload is placed in the last 3 bytes, MSB first */
+    static bool verify( const struct ringbuffer& rb, uint32_t index, uint32_t len )
     {
-        if(( rb.buf[( rb.write_index - 1 ) & rb.size] & 0xfc ) == 0x00U  &&
-             rb.buf[( rb.write_index - 2 ) & rb.size] == 0xD3U )
-        {
-            return true;
-        }
-        return false;
+        uint32_t crc = crc24q( rb, index, len - 3 );
+        return rb.buf[( index + len - 3 ) & rb.size] == uint8_t( crc >> 16 ) &&
+               rb.buf[( index + len - 2 ) & rb.size] == uint8_t( crc >> 8 ) &&
+               rb.buf[( index + len - 1 ) & rb.size] == uint8_t( crc );
     }
 };
 
@@ -0,0 +1,10 @@
+#ifndef __RTOS_STUBS
+#define __RTOS_STUBS
+
+/** FreeRTOS/ASF names used by StreamSeparator, stubbed for running on host. */
+#define CRITICAL_SECTION_ENTER(x)
+#define CRITICAL_SECTION_LEAVE(x)
+#define portYIELD_FROM_ISR(x)
+typedef bool BaseType_t;
+
+#endif //__RTOS_STUBS
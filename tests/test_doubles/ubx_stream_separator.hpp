@@ -1,30 +1,26 @@
 #ifndef __UBX_MSG
 #define __UBX_MSG
 
-struct UBX_Msg
-{
-    UBX_Msg() = delete;
-    ~UBX_Msg() = delete;
+#include "checksum.hpp"
+#include "protocol_descriptor.hpp"
 
-    static constexpr uint32_t BYTE_CONTAINED_LEN = 6;
-    static constexpr uint32_t LEN_OF_SYNC = 2;
+/** UBX msg: SYNC1:SYNC2:CLASS:ID:LENGHT_L:LENGHT_H:.PAYLOAD_OF_LENGHT..:CS_L:CS_H, key is CLASS << 8 | ID */
+inline constexpr ProtocolDescriptor UBX_DESCRIPTOR{
+    { 0xb5, 0x62 }, { 0xff, 0xff }, 2,
+    4, 16, 0, Endian::LITTLE,
+    8,
+    2, 16, 0, Endian::BIG };
 
-    static uint32_t get_len( const struct ringbuffer& rb)
-    {
-        uint8_t data[2];
-        data[0] = rb.buf[( rb.write_index - 2 ) & rb.size];
-        data[1] = rb.buf[( rb.write_index - 1 ) & rb.size];
-        return *((uint16_t*)data) + 8;
-    }
+struct UBX_Msg: DescribedMsg<UBX_DESCRIPTOR> {};
 
-    static bool get_sync( const struct ringbuffer& rb)
+/** UBX_Msg which also checks CK_A:CK_B calculated over CLASS..PAYLOAD */
+struct UBX_Checked_Msg: UBX_Msg
+{
+    static bool verify( const struct ringbuffer& rb, uint32_t index, uint32_t len )
     {
-        if( rb.buf[( rb.write_index - 1 ) & rb.size] == 0x62  &&
-            rb.buf[( rb.write_index - 2 ) & rb.size] == 0xb5 )
-        {
-            return true;
-        }
-        return false;
+        uint16_t ck = fletcher8( rb, index + 2, len - 4 );
+        return rb.buf[( index + len - 2 ) & rb.size] == uint8_t( ck ) &&
+               rb.buf[( index + len - 1 ) & rb.size] == uint8_t( ck >> 8 );
     }
 };
 
@@ -0,0 +1,121 @@
+#include <array>
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+/** including doubles */
+#include "tests/test_doubles/ring_buffer/utils_ringbuffer.h"
+#include "tests/test_doubles/queue/dummy_queue.hpp"
+#include "tests/test_doubles/imu_stream_separator.hpp"
+#include "tests/test_doubles/ubx_stream_separator.hpp"
+#include "tests/test_doubles/rtos_stubs.hpp"
+
+/** including files under test */
+    #include "stream_separator.hpp"
+
+namespace {
+    constexpr std::array<uint8_t, 10> imu_1{ 0xaa, 0x55, 0x01, 0x10, 0x00, 0x20, 0x00, 0x30, 0x00, 0x61 };
+    constexpr std::array<uint8_t, 10> imu_2{ 0xaa, 0x55, 0x02, 0xaa, 0x55, 0x00, 0x01, 0x00, 0x02, 0x04 };
+
+    constexpr std::array<uint8_t, 18> ubx_18{ 0xb5, 0x62, 0x01, 0x3b, 0x0a, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x46, 0x85 };
+};
+
+class Fixed_Len_Msgs_CUT: public ::testing::Test
+{
+public:
+    Fixed_Len_Msgs_CUT()
+    {
+        imu_stream.buffer( ring.data(), ring.size()).create();
+    };
+
+protected:
+    template <size_t n>
+    void push( const std::array<uint8_t, n>& arr )
+    {
+        for ( uint8_t byte : arr )
+        {
+            imu_stream.push( byte );
+        }
+    }
+
+    std::array<uint8_t, 64> ring{0};
+    std::array<uint8_t, 32> buff{0};
+    StreamSeparator<DummyQueue, IMU_Msg> imu_stream;
+};
+
+TEST_F( Fixed_Len_Msgs_CUT, MsgsCompletedByCounter )
+{
+    push( imu_1 );
+    push( imu_2 );
+    push( imu_1 );
+
+    for ( auto& msg : { imu_1, imu_2, imu_1 } )
+    {
+        ASSERT_EQ( imu_stream.next( buff.data(), buff.size()), uint32_t( msg.size()));
+        EXPECT_EQ( memcmp( buff.data(), msg.data(), msg.size()), 0 );
+    }
+    EXPECT_EQ( imu_stream.next( buff.data(), buff.size()), uint32_t( 0 ));
+};
+
+TEST_F( Fixed_Len_Msgs_CUT, MsgsWrappedInBulkAfterNoise )
+{
+    for ( int i = 0; i < 3; i++ )
+    {
+        push( imu_1 );
+        ASSERT_EQ( imu_stream.next( buff.data(), buff.size()), uint32_t( imu_1.size()));
+    }
+
+    std::vector<uint8_t> data{ 0x55, 0xaa, 0x00, 0xaa };
+    for ( int i = 0; i < 5; i++ )
+    {
+        data.insert( data.end(), imu_2.begin(), imu_2.end());
+    }
+    imu_stream.push( data.data(), data.size());
+
+    for ( int i = 0; i < 5; i++ )
+    {
+        ASSERT_EQ( imu_stream.next( buff.data(), buff.size()), uint32_t( imu_2.size()));
+        EXPECT_EQ( memcmp( buff.data(), imu_2.data(), imu_2.size()), 0 );
+    }
+    EXPECT_EQ( imu_stream.next( buff.data(), buff.size()), uint32_t( 0 ));
+};
+
+TEST_F( Fixed_Len_Msgs_CUT, TruncatedMsgRescanned )
+{
+    // the tail of the first msg is lost, the next one starts inside of it
+    std::array<uint8_t, 4> truncated{ 0xaa, 0x55, 0x01, 0x10 };
+    push( truncated );
+    push( imu_1 );
+    push( imu_2 );
+
+    ASSERT_EQ( imu_stream.next( buff.data(), buff.size()), uint32_t( imu_1.size()));
+    EXPECT_EQ( memcmp( buff.data(), imu_1.data(), imu_1.size()), 0 );
+    ASSERT_EQ( imu_stream.next( buff.data(), buff.size()), uint32_t( imu_2.size()));
+    EXPECT_EQ( memcmp( buff.data(), imu_2.data(), imu_2.size()), 0 );
+    EXPECT_EQ( imu_stream.next( buff.data(), buff.size()), uint32_t( 0 ));
+};
+
+TEST( Fixed_Len_Multi_Protocol, ImuMixedWithUbx )
+{
+    std::array<uint8_t, 128> ring{0};
+    MultiStreamSeparator<DummyQueue, UBX_Checked_Msg, IMU_Msg> stream;
+    stream.buffer( ring.data(), ring.size()).create();
+
+    stream.push( imu_1.data(), imu_1.size());
+    stream.push( ubx_18.data(), ubx_18.size());
+    stream.push( imu_2.data(), imu_2.size());
+
+    StreamFrame frame;
+    for ( auto expected : { std::make_pair( stream.protocol_id<IMU_Msg>(), imu_1.size()),
+                            std::make_pair( stream.protocol_id<UBX_Checked_Msg>(), ubx_18.size()),
+                            std::make_pair( stream.protocol_id<IMU_Msg>(), imu_2.size()) } )
+    {
+        ASSERT_TRUE( stream.peek_frame( frame ));
+        EXPECT_EQ( frame.protocol, expected.first );
+        EXPECT_EQ( frame.length(), expected.second );
+        stream.release_frame();
+    }
+    EXPECT_FALSE( stream.peek_frame( frame ));
+};
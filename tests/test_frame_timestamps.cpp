@@ -0,0 +1,120 @@
+#include <array>
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+/** including doubles */
+#include "tests/test_doubles/ring_buffer/utils_ringbuffer.h"
+#include "tests/test_doubles/queue/dummy_queue.hpp"
+#include "tests/test_doubles/ubx_stream_separator.hpp"
+#include "tests/test_doubles/rtos_stubs.hpp"
+
+/** including files under test */
+    #include "stream_separator.hpp"
+
+namespace {
+    constexpr std::array<uint8_t, 18> ubx_18{ 0xb5, 0x62, 0x01, 0x3b, 0x0a, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x46, 0x85 };
+
+    /** time is set by test */
+    struct TickClock
+    {
+        using time_point = uint32_t;
+        static inline time_point ticks{0};
+        static time_point now() { return ticks; }
+    };
+
+    using Times = FrameTimes<uint32_t>;
+};
+
+class Frame_Timestamps_CUT: public ::testing::Test
+{
+public:
+    Frame_Timestamps_CUT()
+    {
+        TickClock::ticks = 0;
+        stream.buffer( ring.data(), ring.size()).create();
+    };
+
+protected:
+    /** msg is pushed byte by byte, the clock ticks once per byte */
+    void push_ticking( uint32_t first_tick )
+    {
+        TickClock::ticks = first_tick;
+        for ( uint8_t byte: ubx_18 )
+        {
+            stream.push( byte );
+            TickClock::ticks++;
+        }
+    }
+
+    std::array<uint8_t, 256> ring{0};
+    std::array<uint8_t, 64> buff{0};
+    StreamSeparator<DummyQueue, UBX_Msg, 16, TickClock> stream;
+};
+
+TEST_F( Frame_Timestamps_CUT, ByteByByteMsgIsStampedAtSyncWordAndAtLastByte )
+{
+    push_ticking( 100 );
+
+    Times times{};
+    EXPECT_EQ( stream.next( buff.data(), buff.size(), times ), int32_t( ubx_18.size()));
+    // the sync word is detected by its second byte
+    EXPECT_EQ( times.sync, uint32_t( 101 ));
+    EXPECT_EQ( times.complete, uint32_t( 100 + ubx_18.size() - 1 ));
+};
+
+TEST_F( Frame_Timestamps_CUT, MsgsOfChunkGetTimeOfChunk )
+{
+    std::vector<uint8_t> chunk{ 0x00, 0x11 };
+    chunk.insert( chunk.end(), ubx_18.begin(), ubx_18.end());
+    chunk.insert( chunk.end(), ubx_18.begin(), ubx_18.begin() + 8 );
+
+    TickClock::ticks = 10;
+    stream.push( chunk.data(), chunk.size());
+    TickClock::ticks = 20;
+    stream.push( &ubx_18[8], ubx_18.size() - 8 );
+
+    Times times{};
+    EXPECT_EQ( stream.next( buff.data(), buff.size(), times ), int32_t( ubx_18.size()));
+    EXPECT_EQ( times.sync, uint32_t( 10 ));
+    EXPECT_EQ( times.complete, uint32_t( 10 ));
+    // the second msg spans both chunks
+    EXPECT_EQ( stream.next( buff.data(), buff.size(), times ), int32_t( ubx_18.size()));
+    EXPECT_EQ( times.sync, uint32_t( 10 ));
+    EXPECT_EQ( times.complete, uint32_t( 20 ));
+};
+
+TEST_F( Frame_Timestamps_CUT, EveryWayOfTakingMsgGivesItsOwnTimes )
+{
+    push_ticking( 100 );
+    push_ticking( 200 );
+    push_ticking( 300 );
+    push_ticking( 400 );
+    // the clock is not sampled for discarded bytes, and they do not shift times of msgs
+    stream.push( 0x00 );
+    push_ticking( 500 );
+
+    StreamFrame frame;
+    Times times{};
+    ASSERT_TRUE( stream.peek_frame( frame, times ));
+    EXPECT_EQ( times.sync, uint32_t( 101 ));
+    stream.release_frame();
+
+    {
+        auto view = stream.next_frame();
+        ASSERT_TRUE( view );
+        EXPECT_EQ( view.times().sync, uint32_t( 201 ));
+        EXPECT_EQ( view.times().complete, uint32_t( 217 ));
+    }
+
+    std::vector<Times> batch;
+    auto sink = [&]( const StreamFrame&, const Times& frame_times ) { batch.push_back( frame_times ); };
+    EXPECT_EQ( stream.next_batch( sink, 16 ), uint32_t( 3 ));
+    ASSERT_EQ( batch.size(), size_t( 3 ));
+    EXPECT_EQ( batch[0].sync, uint32_t( 301 ));
+    EXPECT_EQ( batch[1].sync, uint32_t( 401 ));
+    EXPECT_EQ( batch[2].sync, uint32_t( 501 ));
+    EXPECT_EQ( batch[2].complete, uint32_t( 517 ));
+};
@@ -0,0 +1,102 @@
+#include <array>
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+/** histograms are compiled in only with the flag, separators of this file have their own clock */
+#ifndef STREAM_SEPARATOR_LATENCY_HISTOGRAM
+#define STREAM_SEPARATOR_LATENCY_HISTOGRAM
+#endif
+
+/** including doubles */
+#include "tests/test_doubles/ring_buffer/utils_ringbuffer.h"
+#include "tests/test_doubles/queue/dummy_queue.hpp"
+#include "tests/test_doubles/ubx_stream_separator.hpp"
+#include "tests/test_doubles/rtos_stubs.hpp"
+
+/** including files under test */
+    #include "latency_histogram.hpp"
+    #include "stream_separator.hpp"
+
+namespace {
+    constexpr std::array<uint8_t, 18> ubx_18{ 0xb5, 0x62, 0x01, 0x3b, 0x0a, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x46, 0x85 };
+
+    /** time is set by test */
+    struct TickClock
+    {
+        using time_point = uint32_t;
+        static inline time_point ticks{0};
+        static time_point now() { return ticks; }
+    };
+};
+
+TEST( Latency_Histogram, EmptyHistogramGivesZeros )
+{
+    LatencyHistogram<uint32_t> histogram;
+    auto summary = histogram.summary();
+    EXPECT_EQ( summary.count, uint32_t( 0 ));
+    EXPECT_EQ( summary.p50, uint32_t( 0 ));
+    EXPECT_EQ( summary.p99, uint32_t( 0 ));
+    EXPECT_EQ( summary.max, uint32_t( 0 ));
+};
+
+TEST( Latency_Histogram, PercentilesAreUpperBoundsOfLog2Buckets )
+{
+    LatencyHistogram<uint32_t> histogram;
+    // 98 durations of bucket [4, 8), 2 of bucket [512, 1024)
+    for ( uint32_t i = 0; i < 98; i++ )
+    {
+        histogram.record( 4 + i % 4 );
+    }
+    histogram.record( 600 );
+    histogram.record( 700 );
+
+    auto summary = histogram.summary();
+    EXPECT_EQ( summary.count, uint32_t( 100 ));
+    EXPECT_EQ( summary.p50, uint32_t( 7 ));
+    EXPECT_EQ( summary.p99, uint32_t( 700 ));  // 1023 is more than max
+    EXPECT_EQ( summary.max, uint32_t( 700 ));
+};
+
+TEST( Latency_Histogram, LongestDurationsFitTheLastBucket )
+{
+    LatencyHistogram<uint64_t> histogram;
+    histogram.record( 0 );
+    histogram.record( 0xFFFFFFFFFFFFFFFFULL );
+
+    auto summary = histogram.summary();
+    EXPECT_EQ( summary.p50, uint64_t( 0 ));
+    EXPECT_EQ( summary.p99, 0xFFFFFFFFFFFFFFFFULL );
+};
+
+TEST( Latency_Histogram, SeparatorMeasuresReceivingAndWaitingOfMsgs )
+{
+    std::array<uint8_t, 256> ring{0};
+    std::array<uint8_t, 64> buff{0};
+    StreamSeparator<DummyQueue, UBX_Msg, 16, TickClock> stream;
+    stream.buffer( ring.data(), ring.size()).create();
+
+    for ( uint32_t i = 0; i < 10; i++ )
+    {
+        // the sync word at tick 1001, the msg is complete at 1017 and taken at 1017 + i * 10
+        TickClock::ticks = 1000;
+        for ( uint8_t byte: ubx_18 )
+        {
+            stream.push( byte );
+            TickClock::ticks++;
+        }
+        TickClock::ticks = 1017 + i * 10;
+        EXPECT_EQ( stream.next( buff.data(), buff.size()), int32_t( ubx_18.size()));
+    }
+
+    auto latency = stream.latency();
+    EXPECT_EQ( latency.receiving.count, uint32_t( 10 ));
+    EXPECT_EQ( latency.receiving.p50, uint32_t( 16 ));
+    EXPECT_EQ( latency.receiving.max, uint32_t( 16 ));
+
+    EXPECT_EQ( latency.waiting.count, uint32_t( 10 ));
+    EXPECT_EQ( latency.waiting.p50, uint32_t( 63 ));  // 40 is in [32, 64)
+    EXPECT_EQ( latency.waiting.p99, uint32_t( 90 ));
+    EXPECT_EQ( latency.waiting.max, uint32_t( 90 ));
+};
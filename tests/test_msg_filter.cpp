@@ -0,0 +1,170 @@
+#include <array>
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+/** including doubles */
+#include "tests/test_doubles/ring_buffer/utils_ringbuffer.h"
+#include "tests/test_doubles/queue/dummy_queue.hpp"
+#include "tests/test_doubles/ubx_stream_separator.hpp"
+#include "tests/test_doubles/rtcm3_stream_separator.hpp"
+#include "tests/test_doubles/rtos_stubs.hpp"
+
+/** including files under test */
+    #include "stream_separator.hpp"
+
+namespace {
+    constexpr uint32_t NAV_PVT = 0x0107;
+    constexpr uint32_t RXM_RAWX = 0x0215;
+
+    // msg 1005 from RTCM 10403 example
+    constexpr std::array<uint8_t, 25> msg_1005{ 0xd3, 0x00, 0x13, 0x3e, 0xd7, 0xd3, 0x02, 0x02, 0x98, 0x0e, 0xde,
+            0xef, 0x34, 0xb4, 0xbd, 0x62, 0xac, 0x09, 0x41, 0x98, 0x6f, 0x33, 0x36, 0x0b, 0x98 };
+
+    /** UBX msg of 18 bytes with its number in payload, UBX_Msg does not check checksum */
+    std::vector<uint8_t> ubx( uint32_t key, uint8_t number )
+    {
+        std::vector<uint8_t> msg{ 0xb5, 0x62, uint8_t( key >> 8 ), uint8_t( key ), 0x0a, 0x00 };
+        msg.resize( 18, 0x00 );
+        msg[6] = number;
+        return msg;
+    }
+};
+
+class Msg_Filter_CUT: public ::testing::Test
+{
+public:
+    Msg_Filter_CUT()
+    {
+        stream.buffer( ring.data(), ring.size()).create();
+    };
+
+protected:
+    void push_bytes( const std::vector<uint8_t>& msg )
+    {
+        for ( uint8_t byte: msg )
+        {
+            stream.push( byte );
+        }
+    }
+
+    void push( const std::vector<uint8_t>& bytes )
+    {
+        stream.push( bytes.data(), bytes.size());
+    }
+
+    /** the number of the next msg, -1 if there is no one */
+    int next()
+    {
+        return stream.next( buff.data(), buff.size()) == 18 ? buff[6] : -1;
+    }
+
+    std::array<uint8_t, 64> ring{0};
+    std::array<uint8_t, 64> buff{0};
+    StreamSeparator<DummyQueue, UBX_Msg> stream;
+};
+
+TEST_F( Msg_Filter_CUT, DeniedMsgsAreNotQueued )
+{
+    static constexpr uint32_t denied[] = { NAV_PVT };
+    stream.set_filter( Filter::DENY, denied, 1 );
+
+    push_bytes( ubx( RXM_RAWX, 1 ));
+    push_bytes( ubx( NAV_PVT, 2 ));
+    push_bytes( ubx( RXM_RAWX, 3 ));
+
+    EXPECT_EQ( next(), 1 );
+    EXPECT_EQ( next(), 3 );
+    EXPECT_EQ( next(), -1 );
+
+    StreamStats stats = stream.stats();
+    EXPECT_EQ( stats.filtered_frames, uint32_t( 1 ));
+    EXPECT_EQ( stats.discarded_chars, uint32_t( 0 ));
+};
+
+TEST_F( Msg_Filter_CUT, DroppedMsgsTakeNoSpaceInBuffer )
+{
+    static constexpr uint32_t denied[] = { NAV_PVT };
+    stream.set_filter( Filter::DENY, denied, 1 );
+
+    for ( uint8_t i = 0; i < 10; i++ )
+    {
+        push_bytes( ubx( NAV_PVT, i ));
+    }
+    // msg is dropped by the last byte of its length field, only the bytes before it are ever kept
+    EXPECT_EQ( stream.stats().ring_high_water, uint32_t( 5 ));
+
+    push_bytes( ubx( RXM_RAWX, 1 ));
+    push_bytes( ubx( RXM_RAWX, 2 ));
+    push_bytes( ubx( RXM_RAWX, 3 ));
+    EXPECT_EQ( next(), 1 );
+    EXPECT_EQ( next(), 2 );
+    EXPECT_EQ( next(), 3 );
+
+    StreamStats stats = stream.stats();
+    EXPECT_EQ( stats.filtered_frames, uint32_t( 10 ));
+    EXPECT_EQ( stats.missed_chars, uint32_t( 0 ));
+};
+
+TEST_F( Msg_Filter_CUT, AllowedMsgsOfChunksAreQueuedOnly )
+{
+    static constexpr uint32_t allowed[] = { NAV_PVT, RXM_RAWX };
+    stream.set_filter( Filter::ALLOW, allowed, 2 );
+
+    // the buffer would be full after a few rounds, if bytes of dropped msgs were not given back
+    for ( uint8_t round = 0; round < 20; round++ )
+    {
+        // dropped msg in the middle of chunk and at the end of chunk
+        std::vector<uint8_t> chunk = ubx( 0x013b, 1 );
+        auto pvt = ubx( NAV_PVT, 2 );
+        chunk.insert( chunk.end(), pvt.begin(), pvt.end());
+        auto status = ubx( 0x0a04, 3 );
+        chunk.insert( chunk.end(), status.begin(), status.begin() + 7 );
+        push( chunk );
+        EXPECT_EQ( next(), 2 );
+
+        chunk.assign( status.begin() + 7, status.end());
+        auto raw = ubx( RXM_RAWX, 4 );
+        chunk.insert( chunk.end(), raw.begin(), raw.end());
+        push( chunk );
+        EXPECT_EQ( next(), 4 );
+        EXPECT_EQ( next(), -1 );
+    }
+
+    StreamStats stats = stream.stats();
+    EXPECT_EQ( stats.filtered_frames, uint32_t( 40 ));
+    EXPECT_EQ( stats.missed_chars, uint32_t( 0 ));
+    EXPECT_EQ( stats.discarded_chars, uint32_t( 0 ));
+};
+
+/** msg number of RTCM3 follows its length, so msg is dropped a few bytes later */
+TEST( Msg_Filter, RtcmMsgIsFilteredByNumber )
+{
+    std::array<uint8_t, 128> ring{0};
+    std::array<uint8_t, 64> buff{0};
+    MultiStreamSeparator<DummyQueue, UBX_Msg, RTCM_Msg> stream;
+    static constexpr uint32_t denied[] = { 1005 };
+    stream.buffer( ring.data(), ring.size()).set_filter<RTCM_Msg>( Filter::DENY, denied, 1 ).create();
+
+    std::vector<uint8_t> chunk( msg_1005.begin(), msg_1005.end());
+    auto pvt = ubx( NAV_PVT, 1 );
+    chunk.insert( chunk.end(), pvt.begin(), pvt.end());
+    chunk.insert( chunk.end(), msg_1005.begin(), msg_1005.end());
+    stream.push( chunk.data(), chunk.size());
+    for ( uint8_t byte: msg_1005 )
+    {
+        stream.push( byte );
+    }
+
+    StreamFrame frame;
+    ASSERT_TRUE( stream.peek_frame( frame ));
+    EXPECT_EQ( frame.protocol, stream.protocol_id<UBX_Msg>());
+    EXPECT_EQ( frame[6], 1 );
+    stream.release_frame();
+    EXPECT_EQ( stream.next( buff.data(), buff.size()), 0 );
+
+    StreamStats stats = stream.stats();
+    EXPECT_EQ( stats.filtered_frames, uint32_t( 3 ));
+    EXPECT_EQ( stats.discarded_chars, uint32_t( 0 ));
+};
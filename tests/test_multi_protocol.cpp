@@ -0,0 +1,106 @@
+#include <array>
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+/** including doubles */
+#include "tests/test_doubles/ring_buffer/utils_ringbuffer.h"
+#include "tests/test_doubles/queue/dummy_queue.hpp"
+#include "tests/test_doubles/ubx_stream_separator.hpp"
+#include "tests/test_doubles/rtcm3_stream_separator.hpp"
+#include "tests/test_doubles/rtos_stubs.hpp"
+
+/** including files under test */
+    #include "stream_separator.hpp"
+
+namespace {
+    constexpr std::array<uint8_t, 18> ubx_18{ 0xb5, 0x62, 0x01, 0x3b, 0x0a, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x46, 0x85 };
+
+    constexpr std::array<uint8_t, 25> rtcm_1005{ 0xd3, 0x00, 0x13, 0x3e, 0xd7, 0xd3, 0x02, 0x02, 0x98, 0x0e, 0xde,
+            0xef, 0x34, 0xb4, 0xbd, 0x62, 0xac, 0x09, 0x41, 0x98, 0x6f, 0x33, 0x36, 0x0b, 0x98 };
+
+    constexpr std::array<uint8_t, 5> noise_5{ 0x62, 0xd3, 0xb5, 0x00, 0x13 };
+};
+
+class Multi_Protocol_CUT: public ::testing::Test
+{
+public:
+    using Separator = MultiStreamSeparator<DummyQueue, UBX_Checked_Msg, RTCM_Msg>;
+
+    Multi_Protocol_CUT()
+    {
+        stream.buffer( ring.data(), ring.size()).create();
+    };
+
+protected:
+    template <size_t n>
+    void add( const std::array<uint8_t, n>& arr )
+    {
+        data.insert( data.end(), arr.begin(), arr.end());
+    }
+
+    void expect_next( const uint8_t* msg, uint32_t len, uint8_t protocol )
+    {
+        StreamFrame frame;
+        ASSERT_TRUE( stream.peek_frame( frame ));
+        EXPECT_EQ( frame.protocol, protocol );
+        ASSERT_EQ( frame.length(), len );
+        for ( uint32_t i = 0; i < len; i++ )
+        {
+            EXPECT_EQ( frame[i], msg[i] ) << "at " << i;
+        }
+        stream.release_frame();
+    }
+
+    std::vector<uint8_t> data;
+    std::array<uint8_t, 256> ring{0};
+    Separator stream;
+};
+
+TEST_F( Multi_Protocol_CUT, ProtocolIdIsIndexInList )
+{
+    EXPECT_EQ( Separator::protocol_id<UBX_Checked_Msg>(), uint8_t( 0 ));
+    EXPECT_EQ( Separator::protocol_id<RTCM_Msg>(), uint8_t( 1 ));
+};
+
+TEST_F( Multi_Protocol_CUT, InterleavedMsgsAreTaggedByProtocol )
+{
+    add( noise_5 );
+    add( ubx_18 );
+    add( rtcm_1005 );
+    add( noise_5 );
+    add( rtcm_1005 );
+    add( ubx_18 );
+
+    for ( size_t chunk: { size_t( 1 ), size_t( 7 ), size_t( 64 ) })
+    {
+        for ( size_t i = 0; i < data.size(); i += chunk )
+        {
+            stream.push( &data[i], std::min( chunk, data.size() - i ));
+        }
+
+        expect_next( ubx_18.data(), ubx_18.size(), Separator::protocol_id<UBX_Checked_Msg>());
+        expect_next( rtcm_1005.data(), rtcm_1005.size(), Separator::protocol_id<RTCM_Msg>());
+        expect_next( rtcm_1005.data(), rtcm_1005.size(), Separator::protocol_id<RTCM_Msg>());
+        expect_next( ubx_18.data(), ubx_18.size(), Separator::protocol_id<UBX_Checked_Msg>());
+        StreamFrame frame;
+        EXPECT_FALSE( stream.peek_frame( frame )) << "chunk " << chunk;
+    }
+};
+
+TEST_F( Multi_Protocol_CUT, MsgOfOtherProtocolEmbeddedIntoBrokenOneIsFound )
+{
+    // RTCM msg lost its tail, the UBX msg following it is within announced length
+    std::array<uint8_t, 10> truncated;
+    std::copy( rtcm_1005.begin(), rtcm_1005.begin() + 10, truncated.begin());
+
+    add( truncated );
+    add( ubx_18 );
+    add( rtcm_1005 );
+    stream.push( data.data(), data.size());
+
+    expect_next( ubx_18.data(), ubx_18.size(), Separator::protocol_id<UBX_Checked_Msg>());
+    expect_next( rtcm_1005.data(), rtcm_1005.size(), Separator::protocol_id<RTCM_Msg>());
+};
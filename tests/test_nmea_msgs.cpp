@@ -0,0 +1,199 @@
+#include <array>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+/** including doubles */
+#include "tests/test_doubles/ring_buffer/utils_ringbuffer.h"
+#include "tests/test_doubles/queue/dummy_queue.hpp"
+#include "tests/test_doubles/nmea_stream_separator.hpp"
+#include "tests/test_doubles/ubx_stream_separator.hpp"
+#include "tests/test_doubles/rtos_stubs.hpp"
+
+/** including files under test */
+    #include "stream_separator.hpp"
+
+namespace {
+    const std::string gga{ "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n" };
+    const std::string rmc{ "$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6A\r\n" };
+    const std::string txt{ "$GPTXT,hello\r\n" };
+
+    constexpr std::array<uint8_t, 18> ubx_18{ 0xb5, 0x62, 0x01, 0x3b, 0x0a, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x46, 0x85 };
+};
+
+class NMEA_Msgs_CUT: public ::testing::Test
+{
+public:
+    NMEA_Msgs_CUT()
+    {
+        nmea_stream
+            .buffer( ring.data(), ring.size())
+            .set_timeout( 500 ) // ms.
+            .create();
+    };
+
+protected:
+    void push( const std::string& str )
+    {
+        for ( char c : str )
+        {
+            nmea_stream.push( uint8_t( c ));
+        }
+    }
+
+    void push_bulk( const std::string& str )
+    {
+        nmea_stream.push( reinterpret_cast<const uint8_t*>( str.data()), str.size());
+    }
+
+    std::string next()
+    {
+        uint32_t len = nmea_stream.next( buff.data(), buff.size());
+        return std::string( reinterpret_cast<const char*>( buff.data()), len );
+    }
+
+    std::array<uint8_t, 256> ring{0};
+    std::array<uint8_t, 128> buff{0};
+    StreamSeparator<DummyQueue, NMEA_Msg> nmea_stream;
+};
+
+TEST_F( NMEA_Msgs_CUT, SentencesSplitByTerminator )
+{
+    push( gga );
+    push( rmc );
+    push( txt );
+
+    EXPECT_EQ( next(), gga );
+    EXPECT_EQ( next(), rmc );
+    EXPECT_EQ( next(), txt );
+    EXPECT_EQ( next(), "" );
+};
+
+TEST_F( NMEA_Msgs_CUT, SentencesSplitInBulkAfterNoise )
+{
+    push_bulk( "\n\r garbage" + gga + rmc );
+    push_bulk( txt.substr( 0, 5 ));
+    push_bulk( txt.substr( 5 ) + gga );
+
+    EXPECT_EQ( next(), gga );
+    EXPECT_EQ( next(), rmc );
+    EXPECT_EQ( next(), txt );
+    EXPECT_EQ( next(), gga );
+    EXPECT_EQ( next(), "" );
+};
+
+TEST_F( NMEA_Msgs_CUT, SentenceWithWrongChecksumDiscarded )
+{
+    std::string corrupted = gga;
+    corrupted[10] = '7';
+
+    push( corrupted );
+    push( rmc );
+
+    EXPECT_EQ( next(), rmc );
+    EXPECT_EQ( next(), "" );
+};
+
+TEST_F( NMEA_Msgs_CUT, TooLongSentenceRescanned )
+{
+    // the terminator of the first sentence is lost, the second one is found inside of it
+    std::string truncated = rmc.substr( 0, rmc.size() - 2 );
+
+    push_bulk( truncated + std::string( 20, 'x' ) + gga );
+
+    EXPECT_EQ( next(), gga );
+    EXPECT_EQ( next(), "" );
+};
+
+TEST( NMEA_Small_Buffer, SentenceLongerThanBufferDoesNotBlockIt )
+{
+    std::array<uint8_t, 64> ring{0};
+    std::array<uint8_t, 64> buff{0};
+    StreamSeparator<DummyQueue, NMEA_Msg> stream;
+    stream.buffer( ring.data(), ring.size()).create();
+
+    // it could be longer than MAX_LEN, but not than the buffer
+    std::string endless = "$GPTXT," + std::string( 100, 'x' );
+    for ( char c : endless )
+    {
+        stream.push( uint8_t( c ));
+        EXPECT_EQ( stream.next( buff.data(), buff.size()), uint32_t( 0 ));
+    }
+    EXPECT_EQ( stream.stats().missed_chars, uint32_t( 0 ));
+
+    stream.push( reinterpret_cast<const uint8_t*>( txt.data()), txt.size());
+    EXPECT_EQ( stream.next( buff.data(), buff.size()), txt.size());
+};
+
+TEST( NMEA_Checksum, Xor8OfSentence )
+{
+    std::array<uint8_t, 128> buf{0};
+    memcpy( buf.data(), gga.data(), gga.size());
+    struct ringbuffer rb{ buf.data(), 127, 0, uint32_t( gga.size()) };
+    EXPECT_EQ( xor8( rb, 1, uint32_t( gga.size()) - 6 ), uint8_t( 0x47 ));
+};
+
+TEST( NMEA_Multi_Protocol, NmeaMixedWithUbx )
+{
+    std::array<uint8_t, 256> ring{0};
+    MultiStreamSeparator<DummyQueue, UBX_Checked_Msg, NMEA_Msg> stream;
+    stream.buffer( ring.data(), ring.size()).create();
+
+    stream.push( reinterpret_cast<const uint8_t*>( gga.data()), gga.size());
+    stream.push( ubx_18.data(), ubx_18.size());
+    stream.push( reinterpret_cast<const uint8_t*>( txt.data()), txt.size());
+
+    StreamFrame frame;
+    ASSERT_TRUE( stream.peek_frame( frame ));
+    EXPECT_EQ( frame.protocol, stream.protocol_id<NMEA_Msg>());
+    EXPECT_EQ( frame.length(), gga.size());
+    stream.release_frame();
+
+    ASSERT_TRUE( stream.peek_frame( frame ));
+    EXPECT_EQ( frame.protocol, stream.protocol_id<UBX_Checked_Msg>());
+    EXPECT_EQ( frame.length(), ubx_18.size());
+    stream.release_frame();
+
+    ASSERT_TRUE( stream.peek_frame( frame ));
+    EXPECT_EQ( frame.protocol, stream.protocol_id<NMEA_Msg>());
+    EXPECT_EQ( frame.length(), txt.size());
+    stream.release_frame();
+
+    EXPECT_FALSE( stream.peek_frame( frame ));
+};
+
+/** NMEA sync word is shorter than UBX one, scan of noise in chunk has to stop right at '$' */
+TEST( NMEA_Multi_Protocol, SentenceAfterNoiseInOneChunk )
+{
+    std::array<uint8_t, 256> ring{0};
+    MultiStreamSeparator<DummyQueue, UBX_Checked_Msg, NMEA_Msg> stream;
+    stream.buffer( ring.data(), ring.size()).create();
+
+    std::vector<uint8_t> chunk( 20, 0x11 );
+    chunk.insert( chunk.end(), gga.begin(), gga.end());
+    chunk.insert( chunk.end(), 20, 0x11 );
+    chunk.insert( chunk.end(), ubx_18.begin(), ubx_18.end());
+    chunk.insert( chunk.end(), 20, 0x11 );
+    chunk.insert( chunk.end(), txt.begin(), txt.end());
+    stream.push( chunk.data(), chunk.size());
+
+    StreamFrame frame;
+    ASSERT_TRUE( stream.peek_frame( frame ));
+    EXPECT_EQ( frame.protocol, stream.protocol_id<NMEA_Msg>());
+    EXPECT_EQ( frame.length(), gga.size());
+    stream.release_frame();
+
+    ASSERT_TRUE( stream.peek_frame( frame ));
+    EXPECT_EQ( frame.protocol, stream.protocol_id<UBX_Checked_Msg>());
+    stream.release_frame();
+
+    ASSERT_TRUE( stream.peek_frame( frame ));
+    EXPECT_EQ( frame.protocol, stream.protocol_id<NMEA_Msg>());
+    EXPECT_EQ( frame.length(), txt.size());
+    stream.release_frame();
+
+    EXPECT_FALSE( stream.peek_frame( frame ));
+};
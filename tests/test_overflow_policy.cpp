@@ -0,0 +1,175 @@
+#include <array>
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+/** including doubles */
+#include "tests/test_doubles/ring_buffer/utils_ringbuffer.h"
+#include "tests/test_doubles/queue/dummy_queue.hpp"
+#include "tests/test_doubles/ubx_stream_separator.hpp"
+#include "tests/test_doubles/rtos_stubs.hpp"
+
+/** including files under test */
+    #include "stream_separator.hpp"
+
+namespace {
+    /** msg of 18 bytes with its number in the payload, UBX_Msg does not check checksum */
+    std::array<uint8_t, 18> ubx_18( uint8_t number )
+    {
+        return { 0xb5, 0x62, 0x01, 0x3b, 0x0a, 0x00, number, 0x00, 0x00,
+                 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x46, 0x85 };
+    }
+};
+
+class Overflow_Policy_CUT: public ::testing::Test
+{
+public:
+    Overflow_Policy_CUT()
+    {
+        stream.buffer( ring.data(), ring.size()).create();
+    };
+
+protected:
+    /** msgs are pushed byte by byte as IRQ does */
+    void push( uint8_t number )
+    {
+        for ( uint8_t byte: ubx_18( number ))
+        {
+            stream.push( byte );
+        }
+    }
+
+    /** the number of the next msg, -1 if there is no one, -2 if it's not one of pushed msgs */
+    int next()
+    {
+        uint32_t len = stream.next( buff.data(), buff.size());
+        if ( len == 0 )
+        {
+            return -1;
+        }
+        auto expected = ubx_18( buff[6] );
+        return len == expected.size() && memcmp( buff.data(), expected.data(), len ) == 0 ? buff[6] : -2;
+    }
+
+    // 3 msgs and 10 bytes of the 4th one fit
+    std::array<uint8_t, 64> ring{0};
+    std::array<uint8_t, 64> buff{0};
+    StreamSeparator<DummyQueue, UBX_Msg> stream;
+};
+
+TEST_F( Overflow_Policy_CUT, MissBytesSplicesMsg )
+{
+    for ( uint8_t i = 1; i <= 4; i++ )
+    {
+        push( i );
+    }
+    EXPECT_EQ( next(), 1 );
+    push( 5 );
+
+    EXPECT_EQ( next(), 2 );
+    EXPECT_EQ( next(), 3 );
+    // the beginning of the 4th msg and the end of the 5th one
+    EXPECT_EQ( next(), -2 );
+    EXPECT_EQ( stream.stats().dropped_overflow, uint32_t( 0 ));
+};
+
+TEST_F( Overflow_Policy_CUT, InvalidateMsgDiscardsMsgBeingReceived )
+{
+    stream.set_overflow( Overflow::INVALIDATE_MSG );
+    for ( uint8_t i = 1; i <= 4; i++ )
+    {
+        push( i );
+    }
+    EXPECT_EQ( next(), 1 );
+    push( 5 );
+
+    EXPECT_EQ( next(), 2 );
+    EXPECT_EQ( next(), 3 );
+    EXPECT_EQ( next(), 5 );
+    EXPECT_EQ( next(), -1 );
+
+    StreamStats stats = stream.stats();
+    EXPECT_EQ( stats.dropped_overflow, uint32_t( 1 ));
+    EXPECT_EQ( stats.missed_chars, uint32_t( 8 ));
+};
+
+TEST_F( Overflow_Policy_CUT, DropOldestMakesRoomForNewMsg )
+{
+    stream.set_overflow( Overflow::DROP_OLDEST );
+    for ( uint8_t i = 1; i <= 5; i++ )
+    {
+        push( i );
+    }
+
+    EXPECT_EQ( next(), 3 );
+    EXPECT_EQ( next(), 4 );
+    EXPECT_EQ( next(), 5 );
+    EXPECT_EQ( next(), -1 );
+
+    StreamStats stats = stream.stats();
+    EXPECT_EQ( stats.dropped_overflow, uint32_t( 2 ));
+    EXPECT_EQ( stats.missed_chars, uint32_t( 0 ));
+};
+
+TEST_F( Overflow_Policy_CUT, DropOldestDoesNotDropMsgBeingRead )
+{
+    stream.set_overflow( Overflow::DROP_OLDEST );
+    push( 1 );
+    push( 2 );
+    push( 3 );
+
+    StreamFrame frame;
+    ASSERT_TRUE( stream.peek_frame( frame ));
+    EXPECT_EQ( frame[6], 1 );
+    // nothing could be dropped while thread reads msg, so the 4th msg is invalidated
+    push( 4 );
+    EXPECT_EQ( frame[6], 1 );
+    stream.release_frame();
+
+    push( 5 );
+    EXPECT_EQ( next(), 2 );
+    EXPECT_EQ( next(), 3 );
+    EXPECT_EQ( next(), 5 );
+    EXPECT_EQ( next(), -1 );
+    EXPECT_EQ( stream.stats().dropped_overflow, uint32_t( 1 ));
+};
+
+TEST_F( Overflow_Policy_CUT, RejectAtSyncSkipsMsgWhichDoesNotFit )
+{
+    stream.set_overflow( Overflow::REJECT_AT_SYNC );
+    for ( uint8_t i = 1; i <= 4; i++ )
+    {
+        push( i );
+    }
+    EXPECT_EQ( next(), 1 );
+    push( 5 );
+
+    EXPECT_EQ( next(), 2 );
+    EXPECT_EQ( next(), 3 );
+    EXPECT_EQ( next(), 5 );
+    EXPECT_EQ( next(), -1 );
+
+    // the rest of rejected msg is looked through as noise
+    EXPECT_EQ( stream.stats().dropped_overflow, uint32_t( 1 ));
+};
+
+TEST_F( Overflow_Policy_CUT, RejectAtSyncInBulkPush )
+{
+    stream.set_overflow( Overflow::REJECT_AT_SYNC );
+    std::vector<uint8_t> chunk;
+    for ( uint8_t i = 1; i <= 4; i++ )
+    {
+        auto msg = ubx_18( i );
+        chunk.insert( chunk.end(), msg.begin(), msg.end());
+    }
+    stream.push( chunk.data(), chunk.size());
+
+    EXPECT_EQ( next(), 1 );
+    EXPECT_EQ( next(), 2 );
+    EXPECT_EQ( next(), 3 );
+    EXPECT_EQ( next(), -1 );
+    push( 5 );
+    EXPECT_EQ( next(), 5 );
+    EXPECT_EQ( stream.stats().dropped_overflow, uint32_t( 1 ));
+};
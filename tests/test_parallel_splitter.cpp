@@ -0,0 +1,212 @@
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+/** including doubles */
+#include "tests/test_doubles/ring_buffer/utils_ringbuffer.h"
+#include "tests/test_doubles/ubx_stream_separator.hpp"
+#include "tests/test_doubles/rtcm3_stream_separator.hpp"
+#include "benchmarks/generators.hpp"
+
+/** including files under test */
+    #include "posix_backend.hpp"
+    #include "stream_separator.hpp"
+    #include "tools/parallel_splitter.hpp"
+
+namespace {
+    using Separator = StreamSeparator<PosixQueue, AnyOf<UBX_Checked_Msg, RTCM_Msg>, parallel_splitter::QUEUE_DEPTH>;
+    using parallel_splitter::split_parallel;
+    using parallel_splitter::split_sequential;
+
+    constexpr uint32_t STREAM_BYTES = 2 * 1024 * 1024;
+
+    /** noise with sync words, broken msgs and msgs announcing length up to 64K, which fail checksum at the end */
+    std::vector<uint8_t> hostile_stream( uint32_t seed )
+    {
+        bench::Generator gen( seed );
+        std::mt19937 rnd( seed );
+        std::vector<uint8_t> bytes;
+        while ( bytes.size() < STREAM_BYTES )
+        {
+            switch ( rnd() % 6 )
+            {
+                case 0: { auto msg = gen.ubx( rnd() % 600 ); bytes.insert( bytes.end(), msg.begin(), msg.end()); break; }
+                case 1: { auto msg = gen.rtcm( rnd() % 1024 ); bytes.insert( bytes.end(), msg.begin(), msg.end()); break; }
+                case 2: { auto msg = gen.ubx( rnd() % 64 ); msg[rnd() % msg.size()] ^= 0x10; bytes.insert( bytes.end(), msg.begin(), msg.end()); break; }
+                case 3: { auto msg = gen.rtcm( rnd() % 64 ); bytes.insert( bytes.end(), msg.begin(), msg.begin() + rnd() % msg.size()); break; }
+                case 4: { bytes.insert( bytes.end(), { 0xb5, 0x62, 0x02, 0x15, uint8_t( rnd()), uint8_t( rnd())}); break; }
+                default: gen.noise( bytes, rnd() % 32 ); bytes.push_back( rnd() % 2 ? 0xd3 : 0xb5 ); break;
+            }
+        }
+        return bytes;
+    }
+};
+
+TEST( Parallel_Splitter, SameMsgsAsSequentialSeparator )
+{
+    bench::Generator gen;
+    bench::Stream stream = gen.stream({ "mixed", 8, 1000, 0.3 }, 0.1, STREAM_BYTES );
+    auto expected = split_sequential<Separator>( stream.bytes.data(), stream.bytes.size());
+    ASSERT_EQ( stream.frames, expected.size());
+
+    for ( unsigned jobs: { 2U, 3U, 8U, 16U })
+    {
+        EXPECT_EQ( expected, split_parallel<Separator>( stream.bytes.data(), stream.bytes.size(), jobs )) << jobs << " jobs";
+    }
+}
+
+TEST( Parallel_Splitter, SameMsgsAsSequentialSeparatorInHostileStream )
+{
+    for ( uint32_t seed: { 1U, 2U })
+    {
+        auto bytes = hostile_stream( seed );
+        auto expected = split_sequential<Separator>( bytes.data(), bytes.size());
+        ASSERT_FALSE( expected.empty());
+
+        for ( unsigned jobs: { 2U, 5U, 8U, 13U })
+        {
+            EXPECT_EQ( expected, split_parallel<Separator>( bytes.data(), bytes.size(), jobs ))
+                << "seed " << seed << ", " << jobs << " jobs";
+        }
+    }
+}
+
+/** msg announcing 64K covers the boundary, the chunk after it frames msgs inside of it, which are not true ones */
+TEST( Parallel_Splitter, BoundaryInsideOfLongBrokenMsg )
+{
+    bench::Generator gen;
+    bench::Stream stream = gen.stream({ "ubx_small", 8, 32, 0.0 }, 0.0, STREAM_BYTES );
+    auto& bytes = stream.bytes;
+    const uint8_t fake[] = { 0xb5, 0x62, 0x02, 0x15, 0xff, 0xff };
+    for ( size_t boundary = STREAM_BYTES / 4; boundary < STREAM_BYTES; boundary += STREAM_BYTES / 4 )
+    {
+        memcpy( &bytes[boundary - 1000], fake, sizeof( fake ));
+    }
+
+    auto expected = split_sequential<Separator>( bytes.data(), bytes.size());
+    EXPECT_EQ( expected, split_parallel<Separator>( bytes.data(), bytes.size(), 4 ));
+}
+
+/**
+ * RTCM3 msg covers the boundary, UBX msg starts inside of its payload after the boundary and has a true msg in its own
+ * payload: the chunk after the boundary frames the UBX msg, the sequential separator - RTCM3 one and the msg inside.
+ */
+TEST( Parallel_Splitter, FalseMsgOverlappingTrueOnesAfterBoundary )
+{
+    bench::Generator gen;
+    constexpr uint32_t boundary = STREAM_BYTES / 2;
+    std::vector<uint8_t> bytes = gen.stream({ "ubx_small", 8, 32, 0.0 }, 0.0, boundary - 1000 ).bytes;
+    gen.noise( bytes, boundary - 500 - uint32_t( bytes.size()));
+
+    // RTCM3 msg from boundary - 500 with 600 bytes of payload, the UBX msg is at boundary + 63
+    bytes.insert( bytes.end(), { 0xd3, 0x02, 0x58 });
+    gen.noise( bytes, 560 );
+    size_t ubx = bytes.size();
+    bytes.insert( bytes.end(), { 0xb5, 0x62, 0x02, 0x15, 200, 0 });
+    gen.noise( bytes, 34 );
+    struct ringbuffer rtcm_rb{ &bytes[boundary - 500], 0xFFFFFFFFU, 0, 0xFFFFFFFFU };
+    uint32_t crc = crc24q( rtcm_rb, 0, 603 );
+    bytes.insert( bytes.end(), { uint8_t( crc >> 16 ), uint8_t( crc >> 8 ), uint8_t( crc )});
+
+    gen.noise( bytes, 10 );
+    auto inner = gen.ubx( 16 );
+    size_t inner_offset = bytes.size();
+    bytes.insert( bytes.end(), inner.begin(), inner.end());
+    gen.noise( bytes, uint32_t( ubx + 6 + 200 - bytes.size()));
+    struct ringbuffer ubx_rb{ &bytes[ubx], 0xFFFFFFFFU, 0, 0xFFFFFFFFU };
+    uint16_t ck = fletcher8( ubx_rb, 2, 204 );
+    bytes.insert( bytes.end(), { uint8_t( ck ), uint8_t( ck >> 8 )});
+
+    auto tail = gen.stream({ "ubx_small", 8, 32, 0.0 }, 0.0, STREAM_BYTES - uint32_t( bytes.size())).bytes;
+    bytes.insert( bytes.end(), tail.begin(), tail.end());
+    bytes.resize( STREAM_BYTES );
+
+    auto expected = split_sequential<Separator>( bytes.data(), bytes.size());
+    auto found = [&]( uint64_t offset )
+    {
+        return std::any_of( expected.begin(), expected.end(), [&]( const auto& frame ) { return frame.offset == offset; });
+    };
+    ASSERT_TRUE( found( boundary - 500 ));
+    ASSERT_TRUE( found( inner_offset ));
+    ASSERT_FALSE( found( ubx ));
+
+    EXPECT_EQ( expected, split_parallel<Separator>( bytes.data(), bytes.size(), 2 ));
+}
+
+TEST( Parallel_Splitter, ShortCaptureIsFramedByOneSeparator )
+{
+    bench::Generator gen;
+    auto msg = gen.ubx( 16 );
+    auto frames = split_parallel<Separator>( msg.data(), msg.size(), 8 );
+    ASSERT_EQ( 1U, frames.size());
+    EXPECT_EQ( 0U, frames[0].offset );
+    EXPECT_EQ( msg.size(), frames[0].length );
+}
+
+/** every false sync of corrupt headers is discarded by its own descriptor, chunk of them must not overflow queue */
+TEST( Parallel_Splitter, ChunkOfFalseSyncsDoesNotLoseMsgs )
+{
+    bench::Generator gen;
+    std::vector<uint8_t> bytes;
+    while ( bytes.size() < 12 * 1024 )
+    {
+        bytes.insert( bytes.end(), { 0xd3, 0x00 });
+    }
+    for ( int i = 0; i < 3; i++ )
+    {
+        auto msg = gen.ubx( 16 );
+        bytes.insert( bytes.end(), msg.begin(), msg.end());
+    }
+    // the last false msg announces 217 bytes, the msgs are found when it fails CRC
+    bytes.resize( bytes.size() + 256, 0x00 );
+
+    uint32_t queue_full{1};
+    auto frames = split_sequential<Separator>( bytes.data(), bytes.size(), &queue_full );
+    EXPECT_EQ( 3U, frames.size());
+    EXPECT_EQ( 0U, queue_full );
+}
+
+/**
+ * RTCM3 msg covers the boundary, its payload is made of short UBX msgs: the chunk after the boundary frames them
+ * and loses descriptors on small queue, the sequential separator takes them as payload and loses nothing.
+ */
+TEST( Parallel_Splitter, QueueFullBeforeSyncPointIsNotCounted )
+{
+    using SmallQueueSeparator = StreamSeparator<PosixQueue, AnyOf<UBX_Checked_Msg, RTCM_Msg>, 32>;
+
+    bench::Generator gen;
+    // 3 jobs, 16 msgs of 1008 bytes per CHUNK of separator fit into its queue
+    constexpr uint32_t boundary = ( STREAM_BYTES + 2 ) / 3;
+    std::vector<uint8_t> bytes = gen.stream({ "ubx_large", 1000, 1000, 0.0 }, 0.0, boundary - 1600 ).bytes;
+    bytes.resize( boundary - 500, 0x00 );
+
+    size_t rtcm = bytes.size();
+    bytes.insert( bytes.end(), { 0xd3, 0x03, 0xe8 });
+    for ( int i = 0; i < 125; i++ )
+    {
+        auto msg = gen.ubx( 0 );
+        bytes.insert( bytes.end(), msg.begin(), msg.end());
+    }
+    struct ringbuffer rb{ &bytes[rtcm], 0xFFFFFFFFU, 0, 0xFFFFFFFFU };
+    uint32_t crc = crc24q( rb, 0, 1003 );
+    bytes.insert( bytes.end(), { uint8_t( crc >> 16 ), uint8_t( crc >> 8 ), uint8_t( crc )});
+
+    auto tail = gen.stream({ "ubx_large", 1000, 1000, 0.0 }, 0.0, STREAM_BYTES - uint32_t( bytes.size())).bytes;
+    bytes.insert( bytes.end(), tail.begin(), tail.end());
+    bytes.resize( STREAM_BYTES );
+
+    auto speculative = parallel_splitter::run<SmallQueueSeparator>( bytes.data(), boundary, 2 * boundary,
+                                                                    []( const auto& ) { return true; });
+    ASSERT_NE( 0U, speculative.queue_full );
+
+    uint32_t queue_full{1};
+    auto expected = split_sequential<SmallQueueSeparator>( bytes.data(), bytes.size(), &queue_full );
+    ASSERT_EQ( 0U, queue_full );
+
+    queue_full = 1;
+    EXPECT_EQ( expected, split_parallel<SmallQueueSeparator>( bytes.data(), bytes.size(), 3, &queue_full ));
+    EXPECT_EQ( 0U, queue_full );
+}
@@ -0,0 +1,272 @@
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+/** including doubles */
+#include "tests/test_doubles/ring_buffer/utils_ringbuffer.h"
+#include "tests/test_doubles/ubx_stream_separator.hpp"
+
+/** including files under test */
+    #include "posix_backend.hpp"
+    #include "stream_separator.hpp"
+
+namespace {
+    constexpr std::array<uint8_t, 18> ubx_18{ 0xb5, 0x62, 0x01, 0x3b, 0x0a, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x46, 0x85 };
+
+    /** source of IsrThread giving msgs with sequence number in the payload, up to count of them */
+    struct UbxSource
+    {
+        uint32_t count;
+        uint32_t sent{0};
+
+        size_t operator()( uint8_t* buf, size_t len )
+        {
+            size_t filled{0};
+            while ( sent < count && filled + ubx_18.size() <= len && filled < 3 * ubx_18.size())
+            {
+                make( sent++, &buf[filled] );
+                filled += ubx_18.size();
+            }
+            return filled;
+        }
+
+        static void make( uint32_t seq, uint8_t* msg )
+        {
+            memcpy( msg, ubx_18.data(), ubx_18.size());
+            memcpy( &msg[6], &seq, sizeof( seq ));
+            struct ringbuffer rb{ msg, 0xFFFFFFFFU, 0, uint32_t( ubx_18.size()) };
+            uint16_t ck = fletcher8( rb, 2, uint32_t( ubx_18.size()) - 4 );
+            msg[16] = uint8_t( ck );
+            msg[17] = uint8_t( ck >> 8 );
+        }
+    };
+};
+
+class Posix_Backend_CUT: public ::testing::Test
+{
+public:
+    Posix_Backend_CUT()
+    {
+        stream
+            .buffer( ring.data(), ring.size())
+            .set_timeout( 500 ) // ms.
+            .create();
+    };
+
+protected:
+    std::array<uint8_t, 4096> ring{0};
+    std::array<uint8_t, 64> buff{0};
+    StreamSeparator<PosixQueue, UBX_Checked_Msg, 256> stream;
+};
+
+TEST( Posix_Queue, DequeueHonoursTimeout )
+{
+    PosixQueue queue( 1, sizeof( int32_t ));
+    int32_t token{7};
+
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_FALSE( queue.Dequeue( &token, 30 ));
+    EXPECT_GE( std::chrono::steady_clock::now() - start, std::chrono::milliseconds( 30 ));
+
+    EXPECT_TRUE( queue.Enqueue( &token ));
+    EXPECT_FALSE( queue.Enqueue( &token ));
+    token = 0;
+    EXPECT_TRUE( queue.Dequeue( &token, 0 ));
+    EXPECT_EQ( token, 7 );
+    EXPECT_FALSE( queue.Dequeue( &token, 0 ));
+};
+
+TEST_F( Posix_Backend_CUT, NextBlocksUntilMsgFromIsrThread )
+{
+    std::atomic<bool> sent{ false };
+    IsrThread irq( stream, [&]( uint8_t* buf, size_t ) -> size_t
+    {
+        if ( sent.exchange( true ))
+        {
+            return 0;
+        }
+        std::this_thread::sleep_for( std::chrono::milliseconds( 20 ));
+        memcpy( buf, ubx_18.data(), ubx_18.size());
+        return ubx_18.size();
+    });
+
+    EXPECT_EQ( stream.next( buff.data(), buff.size()), int32_t( ubx_18.size()));
+    EXPECT_EQ( memcmp( buff.data(), ubx_18.data(), ubx_18.size()), 0 );
+    irq.join();
+};
+
+TEST_F( Posix_Backend_CUT, AllMsgsFromIsrThreadInOrder )
+{
+    // the buffer and queue are deep enough to keep all msgs, nothing could be lost
+    IsrThread irq( stream, UbxSource{ 200 });
+
+    for ( uint32_t seq = 0; seq < 200; seq++ )
+    {
+        ASSERT_EQ( stream.next( buff.data(), buff.size()), int32_t( ubx_18.size())) << "at " << seq;
+        uint32_t received;
+        memcpy( &received, &buff[6], sizeof( received ));
+        EXPECT_EQ( received, seq );
+    }
+    irq.join();
+};
+
+TEST_F( Posix_Backend_CUT, FlushWhileIsrThreadIsRunning )
+{
+    std::atomic<bool> done{ false };
+    UbxSource source{ 0xFFFFFFFFU };
+    IsrThread irq( stream, [&]( uint8_t* buf, size_t len ) -> size_t
+    {
+        return done.load() ? 0 : source( buf, len );
+    });
+
+    uint32_t received{0};
+    for ( uint32_t i = 0; i < 2000; i++ )
+    {
+        if ( i % 100 == 0 )
+        {
+            stream.flush();
+        }
+        // only msgs with correct checksum could be returned, even if flush cuts one of them
+        if ( stream.next( buff.data(), buff.size()) == int32_t( ubx_18.size()))
+        {
+            received++;
+        }
+    }
+    done = true;
+    irq.join();
+    EXPECT_GT( received, uint32_t( 0 ));
+};
+
+TEST_F( Posix_Backend_CUT, NextBatchTakesBurstAfterSingleWakeUp )
+{
+    std::atomic<bool> sent{ false };
+    IsrThread irq( stream, [&]( uint8_t* buf, size_t len ) -> size_t
+    {
+        if ( sent.exchange( true ))
+        {
+            return 0;
+        }
+        std::this_thread::sleep_for( std::chrono::milliseconds( 20 ));
+        UbxSource burst{ 3 };
+        return burst( buf, len );
+    });
+
+    uint32_t count{0};
+    auto sink = [&]( const StreamFrame& frame ) { count += frame.length() == ubx_18.size(); };
+    EXPECT_EQ( stream.next_batch( sink, 16 ), uint32_t( 3 ));
+    EXPECT_EQ( count, uint32_t( 3 ));
+    irq.join();
+};
+
+TEST_F( Posix_Backend_CUT, StatsReadWhileIsrThreadIsRunning )
+{
+    IsrThread irq( stream, UbxSource{ 200 });
+
+    StreamStats previous{};
+    uint32_t received{0};
+    while ( received < 200 )
+    {
+        received += stream.next( buff.data(), buff.size()) != 0;
+        StreamStats stats = stream.stats();
+        EXPECT_LE( previous.ring_high_water, stats.ring_high_water );
+        EXPECT_LE( stats.ring_high_water, uint32_t( ring.size()));
+        EXPECT_EQ( stats.delivered_frames, received );
+        previous = stats;
+    }
+    irq.join();
+    EXPECT_EQ( stream.stats().discarded_chars, uint32_t( 0 ));
+};
+
+TEST( Posix_Backend_Overflow, DropOldestWhileThreadIsReadingDeliversWholeMsgs )
+{
+    std::array<uint8_t, 256> ring{0};
+    std::array<uint8_t, 64> buff{0};
+    StreamSeparator<PosixQueue, UBX_Checked_Msg, 16> stream;
+    stream.buffer( ring.data(), ring.size()).set_timeout( 50 ).set_overflow( Overflow::DROP_OLDEST ).create();
+
+    IsrThread irq( stream, UbxSource{ 20000 });
+    uint32_t received{0};
+    int64_t last_seq{ -1 };
+    while ( uint32_t len = stream.next( buff.data(), buff.size()))
+    {
+        ASSERT_EQ( len, ubx_18.size());
+        uint32_t seq;
+        memcpy( &seq, &buff[6], sizeof( seq ));
+        ASSERT_GT( int64_t( seq ), last_seq );
+        last_seq = seq;
+        if ( ++received % 64 == 0 )
+        {
+            // the thread falls behind from time to time
+            std::this_thread::sleep_for( std::chrono::microseconds( 200 ));
+        }
+    }
+    irq.join();
+
+    StreamStats stats = stream.stats();
+    EXPECT_EQ( stats.delivered_frames, received );
+    EXPECT_LE( received + stats.dropped_overflow, uint32_t( 20000 ));
+};
+
+TEST( Posix_Backend_Timestamps, MsgsFromIsrThreadAreStampedBeforeTheyAreTaken )
+{
+    std::array<uint8_t, 4096> ring{0};
+    std::array<uint8_t, 64> buff{0};
+    StreamSeparator<PosixQueue, UBX_Checked_Msg, 256, SteadyClock> stream;
+    stream.buffer( ring.data(), ring.size()).set_timeout( 500 ).create();
+
+    auto start = SteadyClock::now();
+    IsrThread irq( stream, UbxSource{ 100 });
+    SteadyClock::time_point last_complete{ start };
+    for ( uint32_t i = 0; i < 100; i++ )
+    {
+        FrameTimes<SteadyClock::time_point> times{};
+        ASSERT_EQ( stream.next( buff.data(), buff.size(), times ), int32_t( ubx_18.size()));
+        EXPECT_LE( last_complete, times.sync );
+        EXPECT_LE( times.sync, times.complete );
+        EXPECT_LE( times.complete, SteadyClock::now());
+        last_complete = times.complete;
+    }
+    irq.join();
+};
+
+TEST_F( Posix_Backend_CUT, NoMsgWaitsForTimeoutWhileIsrThreadIsStreaming )
+{
+    // the thread takes msgs as fast as IRQ pushes them, so the queue becomes empty and non-empty all the time
+    constexpr uint32_t COUNT = 20000;
+    std::atomic<uint32_t> taken{0};
+    UbxSource source{ COUNT };
+    IsrThread irq( stream, [&]( uint8_t* buf, size_t len ) -> size_t
+    {
+        // IRQ does not run ahead of the thread further than the buffer keeps, no msg is lost
+        while ( taken.load() + 64 < source.sent )
+        {
+            std::this_thread::yield();
+        }
+        return source( buf, len );
+    });
+
+    for ( uint32_t seq = 0; seq < COUNT; seq++ )
+    {
+        auto start = std::chrono::steady_clock::now();
+        int32_t len = stream.next( buff.data(), buff.size());
+        auto waited = std::chrono::steady_clock::now() - start;
+        if ( len != int32_t( ubx_18.size()) || waited >= std::chrono::milliseconds( 500 ))
+        {
+            ADD_FAILURE() << "msg " << seq << " waited for timeout";
+            break;
+        }
+        uint32_t received;
+        memcpy( &received, &buff[6], sizeof( received ));
+        EXPECT_EQ( received, seq );
+        taken++;
+    }
+    // lets IRQ finish if the loop was broken
+    taken = COUNT;
+    irq.join();
+};
@@ -0,0 +1,216 @@
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <deque>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+/** including doubles */
+#include "tests/test_doubles/ring_buffer/utils_ringbuffer.h"
+#include "tests/test_doubles/queue/dummy_queue.hpp"
+#include "tests/test_doubles/imu_stream_separator.hpp"
+#include "tests/test_doubles/ubx_stream_separator.hpp"
+#include "tests/test_doubles/rtos_stubs.hpp"
+
+/** including files under test */
+    #include "stream_separator.hpp"
+
+namespace {
+    /** NAV-PVT ( 0x01 0x07 ) is needed by control loop right away, the rest of UBX msgs is served after it */
+    struct UBX_NavPvtFirst: UBX_Msg
+    {
+        static constexpr uint32_t PRIORITIES = 2;
+
+        static uint32_t priority( const struct ringbuffer& rb, uint32_t index, uint32_t )
+        {
+            return rb.buf[( index + 2 ) & rb.size] == 0x01 && rb.buf[( index + 3 ) & rb.size] == 0x07 ? 0 : 1;
+        }
+    };
+
+    constexpr std::array<uint8_t, 10> imu_1{ 0xaa, 0x55, 0x01, 0x10, 0x00, 0x20, 0x00, 0x30, 0x00, 0x61 };
+
+    /** UBX msg with its number in the first two bytes of payload, UBX_Msg does not check checksum */
+    std::vector<uint8_t> ubx( bool nav_pvt, uint16_t number, uint16_t payload = 10 )
+    {
+        std::vector<uint8_t> msg{ 0xb5, 0x62, uint8_t( nav_pvt ? 0x01 : 0x02 ), uint8_t( nav_pvt ? 0x07 : 0x15 ),
+                                  uint8_t( payload ), uint8_t( payload >> 8 ) };
+        msg.resize( 6 + payload + 2, 0x00 );
+        msg[6] = uint8_t( number );
+        msg[7] = uint8_t( number >> 8 );
+        return msg;
+    }
+};
+
+class Priority_Delivery_CUT: public ::testing::Test
+{
+public:
+    Priority_Delivery_CUT()
+    {
+        stream.buffer( ring.data(), ring.size()).create();
+    };
+
+protected:
+    void push( const std::vector<uint8_t>& bytes )
+    {
+        stream.push( bytes.data(), bytes.size());
+    }
+
+    /** number of the next msg, -1 if there is no one */
+    int next()
+    {
+        int32_t len = stream.next( buff.data(), buff.size());
+        return len < 8 ? -1 : buff[6] | buff[7] << 8;
+    }
+
+    std::array<uint8_t, 64> ring{0};
+    std::array<uint8_t, 512> buff{0};
+    StreamSeparator<DummyQueue, UBX_NavPvtFirst> stream;
+};
+
+TEST_F( Priority_Delivery_CUT, HighClassIsServedFirst )
+{
+    std::vector<uint8_t> ring_1k( 1024 );
+    stream.buffer( ring_1k.data(), ring_1k.size()).create();
+
+    push( ubx( false, 1, 200 ));
+    push( ubx( true, 2 ));
+    push( ubx( false, 3, 200 ));
+    push( ubx( true, 4 ));
+
+    EXPECT_EQ( next(), 2 );
+    EXPECT_EQ( next(), 4 );
+    EXPECT_EQ( next(), 1 );
+    EXPECT_EQ( next(), 3 );
+    EXPECT_EQ( next(), -1 );
+};
+
+TEST_F( Priority_Delivery_CUT, BufferIsGivenBackOnlyUpToOldestWaitingMsg )
+{
+    push( ubx( false, 1 ));
+    push( ubx( true, 2 ));
+    EXPECT_EQ( next(), 2 );
+
+    // the bytes of NAV-PVT stay in buffer after the 1st msg, so only 28 bytes are free
+    push( ubx( false, 3 ));
+    push( ubx( false, 4 ));
+    EXPECT_EQ( stream.stats().missed_chars, uint32_t( 8 ));
+
+    auto expected = ubx( false, 1 );
+    ASSERT_EQ( stream.next( buff.data(), buff.size()), int32_t( expected.size()));
+    EXPECT_EQ( memcmp( buff.data(), expected.data(), expected.size()), 0 );
+    EXPECT_EQ( next(), 3 );
+    // the 4th msg waits for the rest of it
+    EXPECT_EQ( next(), -1 );
+};
+
+TEST_F( Priority_Delivery_CUT, DropOldestDropsOldestMsgOfAnyClass )
+{
+    stream.set_overflow( Overflow::DROP_OLDEST );
+    push( ubx( false, 1 ));
+    push( ubx( true, 2 ));
+    push( ubx( false, 3 ));
+    push( ubx( true, 4 ));
+
+    EXPECT_EQ( next(), 2 );
+    EXPECT_EQ( next(), 4 );
+    EXPECT_EQ( next(), 3 );
+    EXPECT_EQ( next(), -1 );
+
+    StreamStats stats = stream.stats();
+    EXPECT_EQ( stats.dropped_overflow, uint32_t( 1 ));
+    EXPECT_EQ( stats.missed_chars, uint32_t( 0 ));
+};
+
+/** msgs and noise are pushed and taken in random order, as long as they fit into buffer and queues */
+TEST_F( Priority_Delivery_CUT, MsgsStayIntactWhenTakenOutOfOrder )
+{
+    std::array<uint8_t, 256> ring_256{0};
+    stream.buffer( ring_256.data(), ring_256.size()).create();
+
+    struct Pending
+    {
+        uint64_t begin;  // the first byte of noise before msg
+        std::vector<uint8_t> msg;
+    };
+    std::deque<Pending> pending;
+    std::mt19937 rnd( 7 );
+    uint64_t pushed{0};
+    uint16_t number{0};
+    uint32_t taken{0};
+
+    auto take = [&]
+    {
+        auto it = std::find_if( pending.begin(), pending.end(), []( const Pending& p ) { return p.msg[2] == 0x01; });
+        if ( it == pending.end())
+        {
+            it = pending.begin();
+        }
+        ASSERT_EQ( stream.next( buff.data(), buff.size()), int32_t( it->msg.size()));
+        ASSERT_EQ( memcmp( buff.data(), it->msg.data(), it->msg.size()), 0 ) << "msg " << taken;
+        pending.erase( it );
+        taken++;
+    };
+
+    for ( uint32_t step = 0; step < 20000; step++ )
+    {
+        std::vector<uint8_t> unit( rnd() % 8, 0 );
+        for ( auto& byte: unit )
+        {
+            byte = uint8_t( rnd() % 0xb5 );  // no sync word in noise
+        }
+        auto msg = ubx( rnd() % 3 == 0, number, uint16_t( 2 + rnd() % 40 ));
+        unit.insert( unit.end(), msg.begin(), msg.end());
+
+        uint64_t occupied = pending.empty() ? 0 : pushed - pending.front().begin;
+        if ( pending.size() == 7 || occupied + unit.size() > ring_256.size() || rnd() % 3 == 0 )
+        {
+            if ( !pending.empty())
+            {
+                take();
+            }
+            continue;
+        }
+        pending.push_back({ pushed, msg });
+        push( unit );
+        pushed += unit.size();
+        number++;
+    }
+    while ( !pending.empty())
+    {
+        take();
+    }
+
+    StreamStats stats = stream.stats();
+    EXPECT_GT( taken, uint32_t( 1000 ));
+    EXPECT_EQ( stats.missed_chars, uint32_t( 0 ));
+    EXPECT_EQ( stats.queue_full, uint32_t( 0 ));
+    EXPECT_EQ( next(), -1 );
+};
+
+TEST( Priority_Delivery, ConverterWithoutPriorityIsOfLowestClass )
+{
+    std::array<uint8_t, 256> ring{0};
+    std::array<uint8_t, 64> buff{0};
+    MultiStreamSeparator<DummyQueue, UBX_NavPvtFirst, IMU_Msg> stream;
+    stream.buffer( ring.data(), ring.size()).create();
+
+    auto raw = ubx( false, 1 );
+    auto pvt = ubx( true, 2 );
+    stream.push( raw.data(), raw.size());
+    stream.push( imu_1.data(), imu_1.size());
+    stream.push( pvt.data(), pvt.size());
+
+    StreamFrame frame;
+    ASSERT_TRUE( stream.peek_frame( frame ));
+    EXPECT_EQ( frame[3], 0x07 );
+    stream.release_frame();
+    ASSERT_TRUE( stream.peek_frame( frame ));
+    EXPECT_EQ( frame[3], 0x15 );
+    stream.release_frame();
+    ASSERT_TRUE( stream.peek_frame( frame ));
+    EXPECT_EQ( frame.protocol, stream.protocol_id<IMU_Msg>());
+    stream.release_frame();
+    EXPECT_EQ( stream.next( buff.data(), buff.size()), 0 );
+};
@@ -0,0 +1,92 @@
+#include <array>
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+/** including doubles */
+#include "tests/test_doubles/ring_buffer/utils_ringbuffer.h"
+#include "tests/test_doubles/rtcm3_stream_separator.hpp"
+
+/** including files under test */
+    #include "protocol_descriptor.hpp"
+
+namespace {
+    // 4 bytes of sync with don't care nibble, 12 bits of length at bits 2..13 of big endian field
+    inline constexpr ProtocolDescriptor WIDE_DESCRIPTOR{
+        { 0x7e, 0x81, 0x00, 0xa0 }, { 0xff, 0xff, 0x00, 0xf0 }, 4,
+        5, 12, 2, Endian::BIG,
+        10 };
+    using Wide_Msg = DescribedMsg<WIDE_DESCRIPTOR>;
+
+    inline constexpr ProtocolDescriptor LE_DESCRIPTOR{
+        { 0xb5, 0x62 }, { 0xff, 0xff }, 2,
+        4, 16, 0, Endian::LITTLE,
+        8 };
+    using LE_Msg = DescribedMsg<LE_DESCRIPTOR>;
+
+    // hand-written get_len() of UBX_Msg as the reference
+    uint32_t reference_len( const struct ringbuffer& rb )
+    {
+        return uint32_t( rb.buf[( rb.write_index - 2 ) & rb.size] |
+                         rb.buf[( rb.write_index - 1 ) & rb.size] << 8 ) + 8;
+    }
+};
+
+TEST( Protocol_Descriptor, GeneratedMembers )
+{
+    EXPECT_EQ( Wide_Msg::LEN_OF_SYNC, uint32_t( 4 ));
+    EXPECT_EQ( Wide_Msg::BYTE_CONTAINED_LEN, uint32_t( 7 ));
+    EXPECT_EQ( Wide_Msg::SYNC_PATTERN.sync[0], 0x7e );
+    EXPECT_EQ( Wide_Msg::SYNC_PATTERN.mask[1], 0xff );
+    EXPECT_EQ( LE_Msg::BYTE_CONTAINED_LEN, uint32_t( 6 ));
+    EXPECT_EQ( LE_Msg::BYTE_CONTAINED_KEY, uint32_t( 0 ));
+    EXPECT_EQ( RTCM_Msg::BYTE_CONTAINED_KEY, uint32_t( 5 ));
+};
+
+TEST( Protocol_Descriptor, MaskedSyncWordComparedAtOnce )
+{
+    std::array<uint8_t, 8> buf{ 0x00, 0x7e, 0x81, 0x55, 0xa7, 0x00, 0x00, 0x00 };
+    struct ringbuffer rb{ buf.data(), 7, 0, 5 };
+    EXPECT_TRUE( Wide_Msg::get_sync( rb ));
+
+    buf[4] = 0xb7;
+    EXPECT_FALSE( Wide_Msg::get_sync( rb ));
+    buf[4] = 0xa7;
+    buf[1] = 0x7f;
+    EXPECT_FALSE( Wide_Msg::get_sync( rb ));
+
+    // the same sync word wrapped around the end of buffer
+    std::array<uint8_t, 8> wrapped{ 0x55, 0xa0, 0x00, 0x00, 0x00, 0x00, 0x7e, 0x81 };
+    struct ringbuffer rb_wrapped{ wrapped.data(), 7, 0, 10 };
+    EXPECT_TRUE( Wide_Msg::get_sync( rb_wrapped ));
+};
+
+TEST( Protocol_Descriptor, LengthBitsExtracted )
+{
+    // field 0xff 0x56 0x7b: ( 0x567b >> 2 ) & 0xfff = 0x59e
+    std::array<uint8_t, 8> buf{ 0x7e, 0x81, 0x00, 0xa0, 0x00, 0x56, 0x7b, 0x00 };
+    struct ringbuffer rb{ buf.data(), 7, 0, 7 };
+    EXPECT_EQ( Wide_Msg::get_len( rb ), uint32_t( 0x59e + 10 ));
+};
+
+TEST( Protocol_Descriptor, LittleEndianLengthEqualsHandWritten )
+{
+    std::array<uint8_t, 16> buf{0};
+    for ( uint32_t i = 0; i < buf.size(); i++ )
+    {
+        buf[i] = uint8_t( i * 37 + 11 );
+    }
+    for ( uint32_t end = 2; end < 40; end++ )
+    {
+        struct ringbuffer rb{ buf.data(), 15, 0, end };
+        EXPECT_EQ( LE_Msg::get_len( rb ), reference_len( rb )) << "at " << end;
+    }
+};
+
+TEST( Protocol_Descriptor, KeyBitsExtracted )
+{
+    // msg 1005: 0xd3 0x00 0x13 0x3e 0xd7 ..., 12 bits of msg number after length
+    std::array<uint8_t, 8> buf{ 0xd3, 0x00, 0x13, 0x3e, 0xd7, 0xd3, 0x02, 0x02 };
+    struct ringbuffer rb{ buf.data(), 7, 0, RTCM_Msg::BYTE_CONTAINED_KEY };
+    EXPECT_EQ( RTCM_Msg::get_key( rb ), uint32_t( 1005 ));
+};
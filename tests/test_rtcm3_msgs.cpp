@@ -0,0 +1,113 @@
+#include <array>
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+/** including doubles */
+#include "tests/test_doubles/ring_buffer/utils_ringbuffer.h"
+#include "tests/test_doubles/queue/dummy_queue.hpp"
+#include "tests/test_doubles/rtcm3_stream_separator.hpp"
+#include "tests/test_doubles/rtos_stubs.hpp"
+
+/** including files under test */
+    #include "stream_separator.hpp"
+
+namespace {
+    // msg 1005 from RTCM 10403 example
+    constexpr std::array<uint8_t, 25> msg_1005{ 0xd3, 0x00, 0x13, 0x3e, 0xd7, 0xd3, 0x02, 0x02, 0x98, 0x0e, 0xde,
+            0xef, 0x34, 0xb4, 0xbd, 0x62, 0xac, 0x09, 0x41, 0x98, 0x6f, 0x33, 0x36, 0x0b, 0x98 };
+
+    constexpr std::array<uint8_t, 7> noise_7{ 0xd3, 0x01, 0x00, 0xd3, 0xff, 0x13, 0x3e };
+};
+
+class RTCM3_Msgs_CUT: public ::testing::Test
+{
+public:
+    RTCM3_Msgs_CUT()
+    {
+        rtcm_stream
+            .buffer( ring.data(), ring.size())
+            .set_timeout( 500 ) // ms.
+            .create();
+    };
+
+protected:
+    void push( const uint8_t* data, size_t len )
+    {
+        for ( size_t i = 0; i < len; i++ )
+        {
+            rtcm_stream.push( data[i] );
+        }
+    }
+
+    std::array<uint8_t, 64> ring{0};
+    std::array<uint8_t, 1024> buff{0};
+    StreamSeparator<DummyQueue, RTCM_Msg> rtcm_stream;
+};
+
+TEST( RTCM3_Checksum, Crc24qOfExampleMsg )
+{
+    std::array<uint8_t, 32> buf{0};
+    memcpy( buf.data(), msg_1005.data(), msg_1005.size());
+    struct ringbuffer rb{ buf.data(), 31, 0, 25 };
+    EXPECT_EQ( crc24q( rb, 0, 22 ), uint32_t( 0x360b98 ));
+
+    // the same msg wrapped around the end of buffer
+    for ( uint32_t i = 0; i < msg_1005.size(); i++ )
+    {
+        buf[( i + 20 ) & 31] = msg_1005[i];
+    }
+    EXPECT_EQ( crc24q( rb, 20, 22 ), uint32_t( 0x360b98 ));
+};
+
+TEST_F( RTCM3_Msgs_CUT, CorrectMsgsAfterNoise )
+{
+    push( noise_7.data(), noise_7.size());
+    push( msg_1005.data(), msg_1005.size());
+    push( msg_1005.data(), msg_1005.size());
+
+    EXPECT_EQ( rtcm_stream.next( buff.data(), 1024 ), uint32_t( 25 ));
+    EXPECT_EQ( memcmp( buff.data(), msg_1005.data(), msg_1005.size()), 0 );
+    EXPECT_EQ( rtcm_stream.next( buff.data(), 1024 ), uint32_t( 25 ));
+    EXPECT_EQ( memcmp( buff.data(), msg_1005.data(), msg_1005.size()), 0 );
+};
+
+TEST_F( RTCM3_Msgs_CUT, MsgWithWrongCrcDiscarded )
+{
+    auto corrupted = msg_1005;
+    corrupted[10] ^= 0x01;
+
+    push( corrupted.data(), corrupted.size());
+    push( msg_1005.data(), msg_1005.size());
+
+    EXPECT_EQ( rtcm_stream.next( buff.data(), 1024 ), uint32_t( 25 ));
+    EXPECT_EQ( memcmp( buff.data(), msg_1005.data(), msg_1005.size()), 0 );
+    EXPECT_EQ( rtcm_stream.next( buff.data(), 1024 ), uint32_t( 0 ));
+};
+
+TEST( RTCM3_Long_Msg, MsgLongerThan255Bytes )
+{
+    // 300 bytes of payload, length field takes 2 bits of the second byte
+    std::vector<uint8_t> msg{ 0xd3, 0x01, 0x2c };
+    for ( uint32_t i = 0; i < 300; i++ )
+    {
+        msg.push_back( uint8_t( i ));
+    }
+    struct ringbuffer rb{ msg.data(), 0xFFFFFFFFU, 0, uint32_t( msg.size()) };
+    uint32_t crc = crc24q( rb, 0, uint32_t( msg.size()));
+    msg.push_back( uint8_t( crc >> 16 ));
+    msg.push_back( uint8_t( crc >> 8 ));
+    msg.push_back( uint8_t( crc ));
+
+    std::array<uint8_t, 1024> ring{0};
+    std::vector<uint8_t> buff( 1024 );
+    StreamSeparator<DummyQueue, RTCM_Msg> rtcm_stream;
+    rtcm_stream.buffer( ring.data(), ring.size()).create();
+    rtcm_stream.push( msg.data(), msg.size());
+    rtcm_stream.push( msg_1005.data(), msg_1005.size());
+
+    ASSERT_EQ( rtcm_stream.next( buff.data(), 1024 ), uint32_t( msg.size()));
+    EXPECT_EQ( memcmp( buff.data(), msg.data(), msg.size()), 0 );
+    EXPECT_EQ( rtcm_stream.next( buff.data(), 1024 ), uint32_t( 25 ));
+};
@@ -0,0 +1,64 @@
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+/** including files under test */
+    #include "sync_scanner.hpp"
+
+namespace {
+    constexpr SyncPattern ubx{{ 0xb5, 0x62 }, { 0xff, 0xff }};
+    constexpr SyncPattern rtcm{{ 0xd3, 0x00 }, { 0xff, 0xfc }};
+
+    std::vector<uint8_t> noise( size_t len, uint32_t seed )
+    {
+        std::mt19937 gen( seed );
+        std::vector<uint8_t> data( len );
+        for ( auto& byte: data )
+        {
+            byte = uint8_t( gen());
+        }
+        return data;
+    }
+};
+
+TEST( SyncScanner, NoCandidateReturnsLength )
+{
+    std::vector<uint8_t> data( 100, 0x62 );
+    EXPECT_EQ( find_sync( data.data(), data.size(), ubx ), size_t( 100 ));
+    EXPECT_EQ( find_sync( data.data(), 0, ubx ), size_t( 0 ));
+};
+
+TEST( SyncScanner, LastByteIsCandidateIfMatchesFirstByteOfSync )
+{
+    std::vector<uint8_t> data( 70, 0x00 );
+    data.back() = 0xb5;
+    EXPECT_EQ( find_sync( data.data(), data.size(), ubx ), size_t( 69 ));
+};
+
+TEST( SyncScanner, MaskedBitsAreIgnored )
+{
+    std::vector<uint8_t> data( 64, 0xd3 );
+    data[40] = 0xd3;
+    data[41] = 0x03;  // only reserved bits are checked
+    EXPECT_EQ( find_sync( data.data(), data.size(), rtcm ), size_t( 40 ));
+};
+
+TEST( SyncScanner, VectorizedSearchMatchesScalar )
+{
+    for ( uint32_t seed = 0; seed < 200; seed++ )
+    {
+        auto data = noise( 1 + seed * 7, seed );
+        for ( const auto& pattern: { ubx, rtcm } )
+        {
+            // a lot of candidates are found in random data by one byte sync and masked second one
+            for ( size_t from = 0; from < data.size(); )
+            {
+                size_t expected = sync_scanner::find_scalar( data.data(), data.size(), pattern, from );
+                size_t found = from + find_sync( data.data() + from, data.size() - from, pattern );
+                ASSERT_EQ( found, expected ) << "seed " << seed << " from " << from;
+                from = found + 1;
+            }
+        }
+    }
+};
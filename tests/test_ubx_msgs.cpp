@@ -1,3 +1,7 @@
+#include <array>
+#include <cstring>
+#include <vector>
+
 #include "gtest/gtest.h"
 
 /** including doubles */
@@ -5,11 +9,9 @@
 #include "tests/test_doubles/queue/dummy_queue.hpp"
 #include "tests/test_doubles/ubx_stream_separator.hpp"
 
+#include "tests/test_doubles/rtos_stubs.hpp"
+
 /** including files under test */
-#define CRITICAL_SECTION_ENTER(x)
-#define CRITICAL_SECTION_LEAVE(x)
-#define portYIELD_FROM_ISR(x)
-typedef bool BaseType_t;
     #include "stream_separator.hpp"
 
 namespace {
@@ -23,6 +25,9 @@ namespace {
     constexpr static std::array<uint8_t, 18> svin_18{ 0xb5, 0x62, 0x01, 0x3b, 0x0a, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
             0x00, 0x00, 0x00, 0x8a, 0xb5 };
 
+    constexpr static std::array<uint8_t, 18> svin_18_ok{ 0xb5, 0x62, 0x01, 0x3b, 0x0a, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x46, 0x85 };
+
     constexpr std::array<uint8_t, 9> noise_9{ 0x62, 0x01, 0x3b, 0x28, 0x00, 0x90, 0x64, 0xde, 0x1d };
 
     constexpr std::array<uint8_t, 5> zeros_5{ 0x00, 0x00, 0x00, 0x00, 0x00 };
@@ -47,14 +52,14 @@ struct Feed {
         }
     };
 
-    template<class Q, class C>
-    void feed_all( StreamSeparator<Q, C>& separator )
+    template<class Separator>
+    void feed_all( Separator& separator )
     {
         feed_next( separator, msgs.size());
     }
 
-    template<class Q, class C>
-    void push( StreamSeparator<Q, C>& separator, const msg& m )
+    template<class Separator>
+    void push( Separator& separator, const msg& m )
     {
         for ( uint32_t i = 0; i < m.size; ++i )
         {
@@ -62,8 +67,24 @@ struct Feed {
         }
     }
 
-    template<class Q, class C>
-    void feed_next( StreamSeparator<Q, C>& separator, int32_t number = 1 )
+    // all added msgs are pushed as one stream cut into chunks of given size
+    template<class Separator>
+    void feed_all_bulk( Separator& separator, size_t chunk )
+    {
+        std::vector<uint8_t> stream;
+        for ( const auto& m: msgs )
+        {
+            stream.insert( stream.end(), m.stream, m.stream + m.size );
+        }
+        msgs.clear();
+        for ( size_t i = 0; i < stream.size(); i += chunk )
+        {
+            separator.push( &stream[i], std::min( chunk, stream.size() - i ));
+        }
+    }
+
+    template<class Separator>
+    void feed_next( Separator& separator, int32_t number = 1 )
     {
         for ( auto i = 0; i < number && msgs.size(); ++i )
         {
@@ -166,3 +187,399 @@ TEST_F( UBX_Msgs_CUT, TheLastByteEqTheFirstByteOfSyncFalsTriggers )
     len = ubx_stream.next( buff.data(), 1024 );
     EXPECT_EQ( len, uint32_t( 0 )) << "False triggered by the same byte as SYNC1 at the end of msg." ;
 };
+
+TEST_F( UBX_Msgs_CUT, BulkPushOfWholeStreamInOneChunk )
+{
+    f.add( noise_9 );
+    f.add( svin_18 );
+    f.add( svin_48 );
+    f.feed_all_bulk( ubx_stream, 1024 );
+
+    uint32_t len = ubx_stream.next( buff.data(), 1024 );
+    EXPECT_EQ( len, uint32_t( 18 ));
+    len = ubx_stream.next( buff.data(), 1024 );
+    EXPECT_EQ( len, uint32_t( 48 ));
+    EXPECT_EQ( memcmp( buff.data(), svin_48.data(), svin_48.size()), 0 );
+    len = ubx_stream.next( buff.data(), 1024 );
+    EXPECT_EQ( len, uint32_t( 0 ));
+};
+
+TEST_F( UBX_Msgs_CUT, BulkPushChunksWrappedAroundBuffer )
+{
+    // 57 bytes per round, so chunks are copied over the end of 128 bytes buffer
+    for ( auto round = 0; round < 10; round++ )
+    {
+        f.add( noise_9 );
+        f.add( svin_48 );
+        f.feed_all_bulk( ubx_stream, 7 );
+
+        uint32_t len = ubx_stream.next( buff.data(), 1024 );
+        ASSERT_EQ( len, uint32_t( 48 )) << "round " << round;
+        EXPECT_EQ( memcmp( buff.data(), svin_48.data(), svin_48.size()), 0 ) << "round " << round;
+    }
+};
+
+TEST_F( UBX_Msgs_CUT, BulkPushTheLastByteEqTheFirstByteOfSyncFalsTriggers )
+{
+    f.add( svin_18 );
+    f.add( noise_9 );
+    f.feed_all_bulk( ubx_stream, 3 );
+
+    uint32_t len = ubx_stream.next( buff.data(), 1024 );
+    EXPECT_EQ( len, uint32_t( 18 ));
+
+    len = ubx_stream.next( buff.data(), 1024 );
+    EXPECT_EQ( len, uint32_t( 0 )) << "False triggered by the same byte as SYNC1 at the end of msg." ;
+};
+
+TEST_F( UBX_Msgs_CUT, BulkPushChunkLongerThanFreeSpace )
+{
+    f.add( svin_48, 3 );
+    f.feed_all_bulk( ubx_stream, 1024 );
+
+    // only two msgs and 32 bytes of the third one fit into 128 bytes buffer
+    uint32_t len = ubx_stream.next( buff.data(), 1024 );
+    EXPECT_EQ( len, uint32_t( 48 ));
+    len = ubx_stream.next( buff.data(), 1024 );
+    EXPECT_EQ( len, uint32_t( 48 ));
+    len = ubx_stream.next( buff.data(), 1024 );
+    EXPECT_EQ( len, uint32_t( 0 ));
+};
+
+TEST_F( UBX_Msgs_CUT, PeekFramePointsIntoBufferUntilReleased )
+{
+    f.add( noise_9 );
+    f.add( svin_48 );
+    f.feed_all( ubx_stream );
+
+    StreamFrame frame;
+    ASSERT_TRUE( ubx_stream.peek_frame( frame ));
+    EXPECT_EQ( frame.length(), uint32_t( 48 ));
+    EXPECT_EQ( frame.first.data, G_buffer.data() + noise_9.size());
+    EXPECT_EQ( frame.second.size, uint32_t( 0 ));
+    EXPECT_EQ( memcmp( frame.first.data, svin_48.data(), svin_48.size()), 0 );
+    ubx_stream.release_frame();
+
+    EXPECT_FALSE( ubx_stream.peek_frame( frame ));
+};
+
+TEST_F( UBX_Msgs_CUT, PeekFrameWrappedAroundBufferHasTwoParts )
+{
+    f.add( svin_48, 2 );
+    f.feed_all( ubx_stream );
+    EXPECT_EQ( ubx_stream.next( buff.data(), 1024 ), uint32_t( 48 ));
+    EXPECT_EQ( ubx_stream.next( buff.data(), 1024 ), uint32_t( 48 ));
+
+    // the third msg starts at 96 and wraps at 128
+    f.add( svin_48 );
+    f.feed_all( ubx_stream );
+
+    StreamFrame frame;
+    ASSERT_TRUE( ubx_stream.peek_frame( frame ));
+    EXPECT_EQ( frame.first.size, uint32_t( 32 ));
+    EXPECT_EQ( frame.second.data, G_buffer.data());
+    EXPECT_EQ( frame.second.size, uint32_t( 16 ));
+    for ( uint32_t i = 0; i < svin_48.size(); i++ )
+    {
+        EXPECT_EQ( frame[i], svin_48[i] ) << "at " << i;
+    }
+    ubx_stream.release_frame();
+};
+
+TEST_F( UBX_Msgs_CUT, FrameViewReleasesMsgWhenDestroyed )
+{
+    f.add( svin_48 );
+    f.add( svin_18 );
+    f.feed_all( ubx_stream );
+
+    {
+        auto view = ubx_stream.next_frame();
+        ASSERT_TRUE( bool( view ));
+        EXPECT_EQ( view->length(), uint32_t( 48 ));
+    }
+    {
+        auto view = ubx_stream.next_frame();
+        ASSERT_TRUE( bool( view ));
+        EXPECT_EQ( view->length(), uint32_t( 18 ));
+    }
+    EXPECT_FALSE( bool( ubx_stream.next_frame()));
+};
+
+TEST_F( UBX_Msgs_CUT, NextCopiesMsgWrappedAroundBuffer )
+{
+    f.add( svin_48, 2 );
+    f.feed_all( ubx_stream );
+    EXPECT_EQ( ubx_stream.next( buff.data(), 1024 ), uint32_t( 48 ));
+    EXPECT_EQ( ubx_stream.next( buff.data(), 1024 ), uint32_t( 48 ));
+
+    f.add( svin_48 );
+    f.feed_all( ubx_stream );
+    buff.fill( 0 );
+    EXPECT_EQ( ubx_stream.next( buff.data(), 1024 ), uint32_t( 48 ));
+    EXPECT_EQ( memcmp( buff.data(), svin_48.data(), svin_48.size()), 0 );
+};
+
+TEST_F( UBX_Msgs_CUT, MsgLongerThanProvidedBufferDiscarded )
+{
+    f.add( svin_48 );
+    f.add( svin_18 );
+    f.feed_all( ubx_stream );
+
+    EXPECT_EQ( ubx_stream.next( buff.data(), 20 ), uint32_t( 18 ));
+    EXPECT_EQ( ubx_stream.next( buff.data(), 1024 ), uint32_t( 0 ));
+};
+
+TEST( UBX_Msgs_Queue, BurstOfMsgsLongerThanTenFitsIntoDeeperQueue )
+{
+    std::array<uint8_t, 1024> ring{0};
+    std::array<uint8_t, 1024> buff{0};
+    Feed f;
+    StreamSeparator<DummyQueue, UBX_Msg, 64> ubx_stream;
+    ubx_stream.buffer( ring.data(), ring.size()).create();
+
+    f.add( svin_18, 50 );
+    f.feed_all_bulk( ubx_stream, 64 );
+
+    for ( auto i = 0; i < 50; i++ )
+    {
+        ASSERT_EQ( ubx_stream.next( buff.data(), 1024 ), uint32_t( 18 )) << "msg " << i;
+    }
+    EXPECT_EQ( ubx_stream.next( buff.data(), 1024 ), uint32_t( 0 ));
+};
+
+TEST( UBX_Msgs_Queue, LostDescriptorDoesNotShiftFollowingMsgs )
+{
+    std::array<uint8_t, 512> ring{0};
+    std::array<uint8_t, 1024> buff{0};
+    Feed f;
+    StreamSeparator<DummyQueue, UBX_Msg, 4> ubx_stream;
+    ubx_stream.buffer( ring.data(), ring.size()).create();
+
+    // the 5th and 6th msgs do not fit into queue
+    f.add( svin_18, 6 );
+    f.feed_all( ubx_stream );
+    for ( auto i = 0; i < 4; i++ )
+    {
+        ASSERT_EQ( ubx_stream.next( buff.data(), 1024 ), uint32_t( 18 )) << "msg " << i;
+    }
+    EXPECT_EQ( ubx_stream.next( buff.data(), 1024 ), uint32_t( 0 ));
+
+    f.add( noise_9 );
+    f.add( svin_48 );
+    f.feed_all( ubx_stream );
+    EXPECT_EQ( ubx_stream.next( buff.data(), 1024 ), uint32_t( 48 ));
+    EXPECT_EQ( memcmp( buff.data(), svin_48.data(), svin_48.size()), 0 );
+};
+
+TEST( UBX_Msgs_Queue, NoiseFillingBufferDoesNotBlockIt )
+{
+    std::array<uint8_t, 64> ring{0};
+    std::array<uint8_t, 64> buff{0};
+    Feed f;
+    StreamSeparator<DummyQueue, UBX_Msg> ubx_stream;
+    ubx_stream.buffer( ring.data(), ring.size()).create();
+
+    f.add( zeros_5, 20 );
+    f.feed_all_bulk( ubx_stream, 100 );
+    EXPECT_EQ( ubx_stream.next( buff.data(), 64 ), uint32_t( 0 ));
+
+    f.add( zeros_5, 20 );
+    f.add( svin_18 );
+    f.feed_all( ubx_stream );
+    EXPECT_EQ( ubx_stream.next( buff.data(), 64 ), uint32_t( 0 ));
+    f.add( svin_18 );
+    f.feed_all( ubx_stream );
+    EXPECT_EQ( ubx_stream.next( buff.data(), 64 ), uint32_t( 18 ));
+};
+
+TEST( UBX_Msgs_Queue, LostDescriptorsDoNotKeepBufferFull )
+{
+    std::array<uint8_t, 128> ring{0};
+    std::array<uint8_t, 128> buff{0};
+    constexpr std::array<uint8_t, 6> header_120{ 0xb5, 0x62, 0x01, 0x3b, 0x70, 0x00 };
+    Feed f;
+    StreamSeparator<DummyQueue, UBX_Checked_Msg, 4> ubx_stream;
+    ubx_stream.buffer( ring.data(), ring.size()).create();
+
+    // descriptor of noise is lost, the msg after it could fit only into the buffer without the noise
+    f.add( svin_18_ok, 4 );
+    f.add( zeros_5, 4 );
+    f.add( header_120 );
+    f.add( zeros_5, 10 );
+    f.feed_all( ubx_stream );
+    for ( auto i = 0; i < 4; i++ )
+    {
+        ASSERT_EQ( ubx_stream.next( buff.data(), 128 ), uint32_t( 18 ));
+    }
+
+    uint32_t delivered{0};
+    for ( auto i = 0; i < 16; i++ )
+    {
+        f.add( svin_18_ok );
+        f.feed_all( ubx_stream );
+        while ( ubx_stream.next( buff.data(), 128 ) == 18 )
+        {
+            delivered++;
+        }
+    }
+    EXPECT_GE( delivered, uint32_t( 8 ));
+};
+
+TEST_F( UBX_Msgs_CUT, BulkPushFindsSyncInNoiseWithAnyChunkSize )
+{
+    // noise full of the first sync byte, the real sync straddles chunks of all sizes
+    constexpr std::array<uint8_t, 40> sync_like_noise{ 0xb5, 0xb5, 0x00, 0xb5, 0x63, 0x62, 0xb4, 0x62, 0xb5, 0x00,
+            0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11,
+            0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0xb5 };
+
+    for ( size_t chunk = 1; chunk < 80; chunk++ )
+    {
+        f.add( sync_like_noise );
+        f.add( svin_48 );
+        f.feed_all_bulk( ubx_stream, chunk );
+
+        buff.fill( 0 );
+        ASSERT_EQ( ubx_stream.next( buff.data(), 1024 ), uint32_t( 48 )) << "chunk " << chunk;
+        EXPECT_EQ( memcmp( buff.data(), svin_48.data(), svin_48.size()), 0 ) << "chunk " << chunk;
+        EXPECT_EQ( ubx_stream.next( buff.data(), 1024 ), uint32_t( 0 )) << "chunk " << chunk;
+    }
+};
+
+TEST( UBX_Checked_Msgs, MsgWithWrongChecksumDiscarded )
+{
+    std::array<uint8_t, 128> ring{0};
+    std::array<uint8_t, 1024> buff{0};
+    Feed f;
+    StreamSeparator<DummyQueue, UBX_Checked_Msg> ubx_stream;
+    ubx_stream.buffer( ring.data(), ring.size()).create();
+
+    auto corrupted = svin_48;
+    corrupted[20] ^= 0x10;
+
+    f.add( corrupted );
+    f.add( svin_48 );
+    f.add( svin_18 );  // CK_B of it is wrong too
+    f.feed_all( ubx_stream );
+
+    EXPECT_EQ( ubx_stream.next( buff.data(), 1024 ), uint32_t( 48 ));
+    EXPECT_EQ( memcmp( buff.data(), svin_48.data(), svin_48.size()), 0 );
+    EXPECT_EQ( ubx_stream.next( buff.data(), 1024 ), uint32_t( 0 ));
+};
+
+TEST( UBX_Checked_Msgs, MsgEmbeddedIntoTruncatedOneIsFound )
+{
+    std::array<uint8_t, 128> ring{0};
+    std::array<uint8_t, 1024> buff{0};
+    Feed f;
+    StreamSeparator<DummyQueue, UBX_Checked_Msg> ubx_stream;
+    ubx_stream.buffer( ring.data(), ring.size()).create();
+
+    // 18 bytes were lost in the middle of the first msg, so its length covers the next msg completely
+    std::array<uint8_t, 30> truncated;
+    std::copy( svin_48.begin(), svin_48.begin() + 30, truncated.begin());
+
+    f.add( truncated );
+    f.add( svin_18_ok );
+    f.add( svin_48 );
+    f.feed_all( ubx_stream );
+
+    EXPECT_EQ( ubx_stream.next( buff.data(), 1024 ), uint32_t( 18 ));
+    EXPECT_EQ( memcmp( buff.data(), svin_18_ok.data(), svin_18_ok.size()), 0 );
+    EXPECT_EQ( ubx_stream.next( buff.data(), 1024 ), uint32_t( 48 ));
+    EXPECT_EQ( memcmp( buff.data(), svin_48.data(), svin_48.size()), 0 );
+    EXPECT_EQ( ubx_stream.next( buff.data(), 1024 ), uint32_t( 0 ));
+};
+
+TEST_F( UBX_Msgs_CUT, LengthLongerThanBufferIsNotWaitedFor )
+{
+    // false sync announces 65535 bytes of payload
+    constexpr std::array<uint8_t, 6> false_header{ 0xb5, 0x62, 0x01, 0x3b, 0xff, 0xff };
+
+    f.add( false_header );
+    f.add( svin_48 );
+    f.feed_all_bulk( ubx_stream, 5 );
+
+    EXPECT_EQ( ubx_stream.next( buff.data(), 1024 ), uint32_t( 48 ));
+    EXPECT_EQ( memcmp( buff.data(), svin_48.data(), svin_48.size()), 0 );
+    EXPECT_EQ( ubx_stream.next( buff.data(), 1024 ), uint32_t( 0 ));
+};
+
+TEST_F( UBX_Msgs_CUT, NextBatchPassesAllQueuedMsgsToSink )
+{
+    f.add( svin_18, 2 );
+    f.add( noise_9 );
+    f.add( svin_18, 3 );
+    f.feed_all( ubx_stream );
+
+    std::vector<std::vector<uint8_t>> received;
+    auto sink = [&]( const StreamFrame& frame )
+    {
+        std::vector<uint8_t> msg;
+        for ( uint32_t i = 0; i < frame.length(); i++ )
+        {
+            msg.push_back( frame[i] );
+        }
+        received.push_back( msg );
+    };
+
+    EXPECT_EQ( ubx_stream.next_batch( sink, 3 ), uint32_t( 3 ));
+    EXPECT_EQ( ubx_stream.next_batch( sink, 10 ), uint32_t( 2 ));
+    EXPECT_EQ( ubx_stream.next_batch( sink, 10 ), uint32_t( 0 ));
+
+    ASSERT_EQ( received.size(), size_t( 5 ));
+    for ( const auto& msg: received )
+    {
+        ASSERT_EQ( msg.size(), svin_18.size());
+        EXPECT_EQ( memcmp( msg.data(), svin_18.data(), svin_18.size()), 0 );
+    }
+};
+
+TEST_F( UBX_Msgs_CUT, NextBatchReleasesBufferForNextMsgs )
+{
+    uint32_t total{0};
+    auto sink = [&]( const StreamFrame& frame ) { total += frame.length(); };
+
+    // 6 * 48 bytes do not fit into the buffer at once
+    for ( int i = 0; i < 3; i++ )
+    {
+        f.add( svin_48, 2 );
+        f.feed_all( ubx_stream );
+        EXPECT_EQ( ubx_stream.next_batch( sink, 10 ), uint32_t( 2 ));
+    }
+    EXPECT_EQ( total, uint32_t( 6 * 48 ));
+};
+
+TEST_F( UBX_Msgs_CUT, StatsCountNoiseDeliveredAndOversizeMsgs )
+{
+    f.add( noise_9 );
+    f.add( svin_48 );
+    f.add( svin_18 );
+    f.feed_all( ubx_stream );
+
+    StreamStats stats = ubx_stream.stats();
+    EXPECT_EQ( stats.discarded_chars, uint32_t( 9 ));
+    EXPECT_EQ( stats.ring_high_water, uint32_t( 9 + 48 + 18 ));
+    EXPECT_EQ( stats.missed_chars, uint32_t( 0 ));
+
+    EXPECT_EQ( ubx_stream.next( buff.data(), 20 ), uint32_t( 18 ));
+    stats = ubx_stream.stats();
+    EXPECT_EQ( stats.delivered_frames, uint32_t( 1 ));
+    EXPECT_EQ( stats.dropped_oversize, uint32_t( 1 ));
+    EXPECT_EQ( stats.queue_full, uint32_t( 0 ));
+};
+
+TEST( UBX_Msgs_Stats, MissedCharsAndQueueFullEvents )
+{
+    std::array<uint8_t, 64> ring{0};
+    StreamSeparator<DummyQueue, UBX_Msg, 2> stream;
+    stream.buffer( ring.data(), ring.size()).create();
+
+    Feed f;
+    f.add( svin_18, 4 );
+    f.feed_all_bulk( stream, 72 );
+
+    StreamStats stats = stream.stats();
+    EXPECT_EQ( stats.missed_chars, uint32_t( 72 - 64 ));
+    EXPECT_EQ( stats.queue_full, uint32_t( 1 ));
+    EXPECT_EQ( stats.ring_high_water, uint32_t( 64 ));
+};
@@ -0,0 +1,316 @@
+/**
+ * Replay of capture file ( raw stream of receiver, e.g. .ubx or .rtcm3 ) through StreamSeparator.
+ *
+ * The file is mapped into memory and pushed into separator in chunks the same way as DMA callbacks do,
+ * msgs are taken by next_batch() after every chunk ( parallel_splitter::run() ), then written straight from the mapped file.
+ * UBX ( with checksum ) and RTCM3 ( with CRC ) are framed.
+ *
+ *  capture_split [--index index.csv] [--split out_dir] [--jobs N] capture.bin
+ *
+ *  --index  writes line per msg: offset in file, length, protocol, class
+ *  --split  writes msgs of every class into its own file: out_dir/ubx_01_07.ubx, out_dir/rtcm3_1005.rtcm3
+ *  --jobs   frames the file by N threads ( see parallel_splitter.hpp ), msgs are the same as by one separator
+ *
+ * Throughput and counters of separator ( only by one thread ) are reported to stderr. Exits with 1 if output could not
+ * be written or descriptors were lost on full queue ( msgs could be missing ).
+ *
+ * build from the root of repo:
+ *  g++ -O2 -std=c++17 -D_UNIT_TEST_ -I. -Itests/test_doubles/ring_buffer \
+ *      tools/capture_split.cpp tests/test_doubles/ring_buffer/utils_ringbuffer.c -o capture_split -pthread
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "tests/test_doubles/ring_buffer/utils_ringbuffer.h"
+#include "tests/test_doubles/ubx_stream_separator.hpp"
+#include "tests/test_doubles/rtcm3_stream_separator.hpp"
+
+#include "posix_backend.hpp"
+#include "stream_separator.hpp"
+#include "tools/parallel_splitter.hpp"
+
+namespace {
+    using Separator = StreamSeparator<PosixQueue, AnyOf<UBX_Checked_Msg, RTCM_Msg>, parallel_splitter::QUEUE_DEPTH>;
+
+    struct Options
+    {
+        const char* capture{ nullptr };
+        const char* index{ nullptr };
+        const char* split{ nullptr };
+        unsigned jobs{1};
+    };
+
+    bool parse( int argc, char** argv, Options& options )
+    {
+        for ( int i = 1; i < argc; i++ )
+        {
+            if ( strcmp( argv[i], "--index" ) == 0 && i + 1 < argc )
+            {
+                options.index = argv[++i];
+            }
+            else if ( strcmp( argv[i], "--split" ) == 0 && i + 1 < argc )
+            {
+                options.split = argv[++i];
+            }
+            else if ( strcmp( argv[i], "--jobs" ) == 0 && i + 1 < argc )
+            {
+                options.jobs = unsigned( strtoul( argv[++i], nullptr, 10 ));
+                if ( options.jobs == 0 )
+                {
+                    return false;
+                }
+            }
+            else if ( argv[i][0] != '-' && !options.capture )
+            {
+                options.capture = argv[i];
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return options.capture != nullptr;
+    }
+
+    /** name of msg class: ubx_CLASS_ID or rtcm3_NUMBER */
+    std::string msg_class( const StreamFrame& frame )
+    {
+        char name[32];
+        if ( frame.protocol == Separator::protocol_id<UBX_Checked_Msg>())
+        {
+            snprintf( name, sizeof( name ), "ubx_%02x_%02x", frame[2], frame[3] );
+        }
+        else
+        {
+            // the msg number is the first 12 bits of payload, 6 bytes long msg has only header and CRC
+            uint32_t number = frame.length() > 6 ? uint32_t( frame[3] << 4 | frame[4] >> 4 ) : 0;
+            snprintf( name, sizeof( name ), "rtcm3_%u", number );
+        }
+        return name;
+    }
+
+    /** every file which could not be created, written or closed is reported to stderr once and fails ok() */
+    class Output
+    {
+    public:
+        explicit Output( const Options& options ): split{ options.split }, index_path{ options.index }
+        {
+            if ( options.index )
+            {
+                index = fopen( options.index, "w" );
+                if ( !index )
+                {
+                    index_failed();
+                    return;
+                }
+                if ( fprintf( index, "offset,length,protocol,class\n" ) < 0 )
+                {
+                    index_failed();
+                }
+            }
+        }
+        /** only if close() was not called, e.g. on early return */
+        ~Output()
+        {
+            close();
+        }
+
+        /**
+         * Flushes and closes all files, buffered data is written only now, so ok() is final after it.
+         * @return ok()
+         */
+        bool close()
+        {
+            if ( index && fclose( index ) != 0 )
+            {
+                index_failed();
+            }
+            index = nullptr;
+            for ( auto& file: files )
+            {
+                if ( fclose( file.second ) != 0 )
+                {
+                    file_failed( file.first );
+                }
+            }
+            files.clear();
+            return ok();
+        }
+
+        /** the index could not be created */
+        bool failed() const { return !index_ok; }
+        bool ok() const { return index_ok && files_ok; }
+
+        void write( uint64_t offset, const StreamFrame& frame )
+        {
+            frames[frame.protocol]++;
+            if ( !index && !split )
+            {
+                return;
+            }
+            std::string name = msg_class( frame );
+            if ( index && index_ok )
+            {
+                if ( fprintf( index, "%llu,%u,%s,%s\n", static_cast<unsigned long long>( offset ), frame.length(),
+                              frame.protocol == Separator::protocol_id<UBX_Checked_Msg>() ? "ubx" : "rtcm3",
+                              name.c_str()) < 0 )
+                {
+                    index_failed();
+                }
+            }
+            if ( split )
+            {
+                name += frame.protocol == Separator::protocol_id<UBX_Checked_Msg>() ? ".ubx" : ".rtcm3";
+                FILE*& file = files[name];
+                if ( !file )
+                {
+                    file = fopen(( std::string( split ) + "/" + name ).c_str(), "wb" );
+                    if ( !file )
+                    {
+                        files.erase( name );
+                        file_failed( name );
+                        return;
+                    }
+                }
+                if ( fwrite( frame.first.data, 1, frame.first.size, file ) != frame.first.size ||
+                     fwrite( frame.second.data, 1, frame.second.size, file ) != frame.second.size )
+                {
+                    file_failed( name );
+                }
+            }
+        }
+
+        uint64_t frames[2]{};
+
+    private:
+        const char* split;
+        const char* index_path;
+        FILE* index{ nullptr };
+        /** by file name in split directory */
+        std::map<std::string, FILE*> files;
+        bool index_ok{ true };
+        bool files_ok{ true };
+
+        void index_failed()
+        {
+            if ( index_ok )
+            {
+                perror( index_path );
+                index_ok = false;
+            }
+        }
+
+        /** only the first failed file is reported, the rest very likely fail for the same reason */
+        void file_failed( const std::string& name )
+        {
+            if ( files_ok )
+            {
+                perror(( std::string( split ) + "/" + name ).c_str());
+                files_ok = false;
+            }
+        }
+    };
+
+    /** one separator over the whole file, its counters are reported. @return descriptors lost on full queue */
+    uint32_t sequential( const uint8_t* capture, size_t size, Output& output )
+    {
+        auto begin = std::chrono::steady_clock::now();
+        StreamStats stats = parallel_splitter::run<Separator>( capture, 0, size, [&]( const parallel_splitter::FrameRecord& record )
+        {
+            output.write( record.offset, StreamFrame{{ &capture[record.offset], record.length }, { nullptr, 0 }, record.protocol });
+            return true;
+        });
+        double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - begin ).count();
+
+        fprintf( stderr, "%zu bytes in %.3f s, %.1f MB/s\n", size, seconds, seconds > 0 ? double( size ) / seconds / 1e6 : 0.0 );
+        fprintf( stderr, "ubx %llu, rtcm3 %llu msgs, discarded %u bytes, queue full %u, missed %u bytes\n",
+                 static_cast<unsigned long long>( output.frames[0] ), static_cast<unsigned long long>( output.frames[1] ),
+                 stats.discarded_chars, stats.queue_full, stats.missed_chars );
+        return stats.queue_full;
+    }
+}
+
+int main( int argc, char** argv )
+{
+    Options options;
+    if ( !parse( argc, argv, options ))
+    {
+        fprintf( stderr, "usage: %s [--index index.csv] [--split out_dir] [--jobs N] capture.bin\n", argv[0] );
+        return 2;
+    }
+
+    int fd = open( options.capture, O_RDONLY );
+    struct stat st;
+    if ( fd < 0 || fstat( fd, &st ) != 0 )
+    {
+        perror( options.capture );
+        return 1;
+    }
+    size_t size = size_t( st.st_size );
+    const uint8_t* capture = nullptr;
+    if ( size != 0 )
+    {
+        void* mapped = mmap( nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0 );
+        if ( mapped == MAP_FAILED )
+        {
+            perror( "mmap" );
+            return 1;
+        }
+        madvise( mapped, size, MADV_SEQUENTIAL );
+        capture = static_cast<const uint8_t*>( mapped );
+    }
+
+    Output output( options );
+    if ( output.failed())
+    {
+        return 1;
+    }
+    uint32_t queue_full{0};
+    if ( options.jobs > 1 )
+    {
+        auto begin = std::chrono::steady_clock::now();
+        auto frames = parallel_splitter::split_parallel<Separator>( capture, size, options.jobs, &queue_full );
+        double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - begin ).count();
+        // msgs are taken right from the mapped file
+        for ( const auto& record: frames )
+        {
+            output.write( record.offset, StreamFrame{{ &capture[record.offset], record.length }, { nullptr, 0 }, record.protocol });
+        }
+        fprintf( stderr, "%zu bytes in %.3f s by %u jobs, %.1f MB/s\n", size, seconds, options.jobs,
+                 seconds > 0 ? double( size ) / seconds / 1e6 : 0.0 );
+        fprintf( stderr, "ubx %llu, rtcm3 %llu msgs, queue full %u\n",
+                 static_cast<unsigned long long>( output.frames[0] ), static_cast<unsigned long long>( output.frames[1] ),
+                 queue_full );
+    }
+    else
+    {
+        queue_full = sequential( capture, size, output );
+    }
+
+    if ( capture )
+    {
+        munmap( const_cast<uint8_t*>( capture ), size );
+    }
+    close( fd );
+    if ( !output.close())
+    {
+        fprintf( stderr, "output could not be written\n" );
+        return 1;
+    }
+    if ( queue_full != 0 )
+    {
+        fprintf( stderr, "descriptors were lost on full queue, some msgs could be missing\n" );
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,195 @@
+/**
+ * Framing of the whole capture in memory by StreamSeparator, sequentially or by several threads.
+ *
+ * split_sequential<Separator>( data, size ) - reference: one separator over the whole capture.
+ * split_parallel<Separator>( data, size, jobs ) - the same result, the capture is cut into jobs chunks:
+ *  1. every chunk is framed by its own separator in parallel, as if the stream started at its beginning;
+ *  2. boundaries are reconciled sequentially: separator is restarted from the end of the last true msg
+ *     before the boundary and runs until it completes a msg exactly where the speculative run of the chunk
+ *     completed one ( or at the beginning of chunk ). From that point both runs are in the same state
+ *     ( looking for sync, nothing received ), so msgs of the chunk after it are taken as they are.
+ *  Usually the restarted separator runs over one or two msgs per boundary. The speculative run which lost
+ *  descriptors on full queue is not synced with, the restarted separator frames the whole chunk instead.
+ *
+ * Separator is StreamSeparator with PosixQueue ( timeout 0 ) and QUEUE_DEPTH of at least QUEUE_DEPTH below,
+ * the longest msg has to fit into RING_SIZE. Msgs are returned as offsets in capture, so they could be taken from it zero-copy.
+ * Descriptors lost on full queue by the runs whose msgs are returned are counted to queue_full ( if given ),
+ * msgs could be missing then.
+ */
+#ifndef __PARALLEL_SPLITTER__
+#define __PARALLEL_SPLITTER__
+
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "posix_backend.hpp"
+#include "stream_separator.hpp"
+
+namespace parallel_splitter {
+
+struct FrameRecord
+{
+    uint64_t offset;
+    uint32_t length;
+    uint8_t protocol;
+
+    uint64_t end() const { return offset + length; }
+
+    bool operator==( const FrameRecord& other ) const
+    {
+        return offset == other.offset && length == other.length && protocol == other.protocol;
+    }
+};
+
+constexpr uint32_t RING_SIZE = 1024 * 1024;
+constexpr uint32_t CHUNK = 16 * 1024;
+/**
+ * Every byte of chunk could end a descriptor ( rejected false sync is discarded by its own one ), and bytes of bogus msg
+ * received before the chunk are searched again for sync in it.
+ */
+constexpr uint32_t QUEUE_DEPTH = 2 * CHUNK;
+
+/**
+ * Runs separator over data[begin, end) in CHUNK pieces, calls on_frame( const FrameRecord& ) for every msg,
+ * stops as soon as on_frame returns false.
+ * @return counters of separator.
+ */
+template<class Separator, class OnFrame>
+StreamStats run( const uint8_t* data, uint64_t begin, uint64_t end, OnFrame on_frame )
+{
+    std::vector<uint8_t> ring( RING_SIZE );
+    Separator separator;
+    separator.buffer( ring.data(), RING_SIZE ).create();
+
+    // nothing is missed, so the write index of buffer is the number of pushed bytes
+    uint64_t pushed{0};
+    bool proceed{ true };
+    auto sink = [&]( const StreamFrame& frame )
+    {
+        if ( !proceed )
+        {
+            return;
+        }
+        uint32_t start = uint32_t( frame.first.data - ring.data());
+        uint64_t offset = begin + pushed - (( uint32_t( pushed ) - start ) & ( RING_SIZE - 1 ));
+        proceed = on_frame( FrameRecord{ offset, frame.length(), frame.protocol });
+    };
+
+    for ( uint64_t i = begin; i < end && proceed; i += CHUNK )
+    {
+        size_t len = size_t( std::min<uint64_t>( CHUNK, end - i ));
+        separator.push( &data[i], len );
+        pushed += len;
+        while ( proceed && separator.next_batch( sink, 0xFFFFFFFFU ) != 0 );
+    }
+    return separator.stats();
+}
+
+template<class Separator>
+std::vector<FrameRecord> split_sequential( const uint8_t* data, uint64_t size, uint32_t* queue_full = nullptr )
+{
+    std::vector<FrameRecord> frames;
+    StreamStats stats = run<Separator>( data, 0, size, [&]( const FrameRecord& frame )
+    {
+        frames.push_back( frame );
+        return true;
+    });
+    if ( queue_full )
+    {
+        *queue_full = stats.queue_full;
+    }
+    return frames;
+}
+
+template<class Separator>
+std::vector<FrameRecord> split_parallel( const uint8_t* data, uint64_t size, unsigned jobs, uint32_t* queue_full = nullptr )
+{
+    uint64_t chunk = ( size + jobs - 1 ) / std::max( jobs, 1U );
+    if ( jobs <= 1 || chunk < 4 * CHUNK )
+    {
+        return split_sequential<Separator>( data, size, queue_full );
+    }
+
+    struct Part
+    {
+        uint64_t begin;
+        uint64_t end;
+        std::vector<FrameRecord> frames;
+        std::unordered_set<uint64_t> sync_points;  /** where the speculative run is looking for sync from scratch */
+        uint32_t queue_full;                       /** msgs of the run could be missing anywhere, even after sync */
+    };
+    std::vector<Part> parts;
+    for ( uint64_t begin = 0; begin < size; begin += chunk )
+    {
+        parts.push_back({ begin, std::min( begin + chunk, size ), {}, {}, 0 });
+    }
+
+    std::vector<std::thread> workers;
+    for ( auto& part: parts )
+    {
+        workers.emplace_back([&part, data]
+        {
+            part.sync_points.insert( part.begin );
+            part.queue_full = run<Separator>( data, part.begin, part.end, [&]( const FrameRecord& frame )
+            {
+                part.frames.push_back( frame );
+                part.sync_points.insert( frame.end());
+                return true;
+            }).queue_full;
+        });
+    }
+    for ( auto& worker: workers )
+    {
+        worker.join();
+    }
+
+    auto part_of = [&]( uint64_t position ) { return size_t( std::min<uint64_t>( position / chunk, parts.size() - 1 )); };
+
+    // the first chunk is the beginning of stream, so its run is not speculative
+    uint32_t lost = parts[0].queue_full;
+    std::vector<FrameRecord> frames = std::move( parts[0].frames );
+    size_t next = 1;
+    while ( next < parts.size())
+    {
+        // the true state at restart is looking for sync from scratch: after true msg or at the beginning
+        uint64_t restart = frames.empty() ? 0 : frames.back().end();
+        size_t synced = parts.size();
+        uint64_t synced_at{0};
+        lost += run<Separator>( data, restart, size, [&]( const FrameRecord& frame )
+        {
+            frames.push_back( frame );
+            size_t i = part_of( frame.end());
+            if ( i >= next && parts[i].queue_full == 0 && parts[i].sync_points.count( frame.end()))
+            {
+                synced = i;
+                synced_at = frame.end();
+                return false;
+            }
+            return true;
+        }).queue_full;
+        if ( synced == parts.size())
+        {
+            break;  // the restarted separator reached the end of capture
+        }
+        for ( const auto& frame: parts[synced].frames )
+        {
+            if ( frame.offset >= synced_at )
+            {
+                frames.push_back( frame );
+            }
+        }
+        next = synced + 1;
+    }
+    if ( queue_full )
+    {
+        *queue_full = lost;
+    }
+    return frames;
+}
+
+} // namespace parallel_splitter
+
+#endif //__PARALLEL_SPLITTER__